@@ -0,0 +1,12 @@
+function(apply_cpu_dispatch_settings target)
+    if(CPU_DISPATCH STREQUAL "COMPUTED_GOTO")
+        if(NOT CMAKE_CXX_COMPILER_ID MATCHES "GNU|Clang")
+            message(FATAL_ERROR "CPU_DISPATCH=COMPUTED_GOTO requires GCC or Clang")
+        endif()
+        # Jump straight to per opcode labels (labels as values extension)
+        target_compile_definitions(${target} PRIVATE GB_CPU_DISPATCH_COMPUTED_GOTO)
+    elseif(NOT CPU_DISPATCH STREQUAL "TABLE")
+        message(FATAL_ERROR "Unknown CPU_DISPATCH: ${CPU_DISPATCH}. "
+                            "Choose: COMPUTED_GOTO TABLE")
+    endif()
+endfunction()
@@ -0,0 +1,15 @@
+function(apply_simd_settings target)
+    if(SIMD STREQUAL "AVX2")
+        # Binary will only run on cpus with avx2
+        target_compile_options(${target} PRIVATE
+            $<$<OR:$<CXX_COMPILER_ID:GNU>,$<CXX_COMPILER_ID:Clang>>:-mavx2>
+            $<$<CXX_COMPILER_ID:MSVC>:/arch:AVX2>
+        )
+    elseif(SIMD STREQUAL "NONE")
+        # Scalar code only, e.g to compare against the vectorized paths
+        target_compile_definitions(${target} PRIVATE GB_SIMD_NONE)
+    elseif(NOT SIMD STREQUAL "AUTO")
+        message(FATAL_ERROR "Unknown SIMD: ${SIMD}. "
+                            "Choose: AUTO AVX2 NONE")
+    endif()
+endfunction()
@@ -0,0 +1,131 @@
+#include "batchrunner.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+
+#include "machine.hpp"
+#include "memorydisplay.hpp"
+#include "movie.hpp"
+
+BatchRunner::BatchRunner(unsigned int threadCount)
+    : _threadCount(threadCount != 0
+                       ? threadCount
+                       : std::max(std::thread::hardware_concurrency(), 1U))
+{
+  for (unsigned int i{0}; i < _threadCount; ++i)
+  {
+    _queues.push_back(std::make_unique<WorkQueue>());
+  }
+}
+
+std::vector<BatchResult> BatchRunner::Run(std::span<const BatchJob> jobs)
+{
+  std::vector<BatchResult> results(jobs.size());
+  // contiguous slices, job i goes to queue i * threads / jobs
+  for (std::size_t i{0}; i < jobs.size(); ++i)
+  {
+    _queues[i * _threadCount / jobs.size()]->jobs.push_back(i);
+  }
+
+  {
+    std::vector<std::jthread> threads;
+    auto threadCount =
+        std::min(static_cast<std::size_t>(_threadCount), jobs.size());
+    for (std::size_t worker{0}; worker < threadCount; ++worker)
+    {
+      threads.emplace_back([this, worker, jobs, &results] {
+        while (auto job = NextJob(worker))
+        {
+          // every job writes its own result, no locking needed
+          results[*job] = RunJob(jobs[*job]);
+        }
+      });
+    }
+    // jthreads join here
+  }
+  // unmap the roms, files may change between batches
+  _images.clear();
+  return results;
+}
+
+unsigned int BatchRunner::ThreadCount() const
+{
+  return _threadCount;
+}
+
+std::optional<std::size_t> BatchRunner::NextJob(std::size_t worker)
+{
+  {
+    auto &own = *_queues[worker];
+    std::lock_guard lock{own.mutex};
+    if (!own.jobs.empty())
+    {
+      auto job = own.jobs.front();
+      own.jobs.pop_front();
+      return job;
+    }
+  }
+
+  for (std::size_t i{1}; i < _queues.size(); ++i)
+  {
+    auto &victim = *_queues[(worker + i) % _queues.size()];
+    std::lock_guard lock{victim.mutex};
+    if (!victim.jobs.empty())
+    {
+      auto job = victim.jobs.back();
+      victim.jobs.pop_back();
+      return job;
+    }
+  }
+  return std::nullopt;
+}
+
+BatchResult BatchRunner::RunJob(const BatchJob &job)
+{
+  BatchResult result;
+  try
+  {
+    Movie movie;
+    if (!job.moviePath.empty())
+    {
+      movie = Movie::Load(job.moviePath);
+    }
+    auto frames = job.frames != 0 ? job.frames : movie.FrameCount();
+    if (frames == 0)
+    {
+      throw std::invalid_argument("Job has neither a frame count nor a movie");
+    }
+
+    // only the last frame is reported, it's hashed once at the end
+    MemoryDisplay display{false};
+    Machine machine{Image(job.bootRomPath), Image(job.romPath), display,
+        job.renderMode};
+    while (machine.FrameCount() < frames)
+    {
+      machine.SetButtons(movie.ButtonsAt(machine.FrameCount()));
+      machine.RunFrame();
+    }
+    result.frames = machine.FrameCount();
+    result.frameHash = display.HashFramebuffer();
+  }
+  catch (std::exception &ex)
+  {
+    result.error = ex.what();
+  }
+  return result;
+}
+
+std::shared_ptr<const RomImage> BatchRunner::Image(const std::string &filePath)
+{
+  std::lock_guard lock{_imagesMutex};
+  if (auto it = _images.find(filePath); it != _images.end())
+  {
+    return it->second;
+  }
+  // a rom that can't be mapped isn't cached, every job using it fails
+  auto image = RomImage::Open(filePath);
+  _images.emplace(filePath, image);
+  return image;
+}
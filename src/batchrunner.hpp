@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "ppu.hpp"
+#include "romimage.hpp"
+
+// One run of a machine from power on
+struct BatchJob
+{
+  std::string bootRomPath;
+  std::string romPath;
+  // movie whose input is replayed, empty runs without input
+  std::string moviePath;
+  // frames to run, 0 runs for the length of the movie
+  std::uint64_t frames{};
+  Ppu::RenderMode renderMode{Ppu::RenderMode::Dot};
+};
+
+struct BatchResult
+{
+  // frames that were run and the hash of the last one
+  std::uint64_t frames{};
+  std::uint64_t frameHash{};
+  // why the job failed, empty if it ran
+  std::string error;
+};
+
+// Runs many machines on a pool of threads. A machine owns all of its state,
+// so jobs share nothing and each one runs start to end on a single thread.
+//
+// Jobs are split into one contiguous queue per thread up front. A thread
+// takes jobs from the front of its own queue and, once it runs dry, steals
+// from the back of the others, so a few long jobs don't leave the other
+// threads idle at the end of a batch.
+//
+// Every rom file is mapped once per batch and shared by all the machines
+// running it.
+class BatchRunner
+{
+public:
+  // threadCount 0 uses one thread per hardware thread
+  explicit BatchRunner(unsigned int threadCount);
+
+  // Run every job, results are in the order of jobs. A job that throws only
+  // fails its own result
+  [[nodiscard]]
+  std::vector<BatchResult> Run(std::span<const BatchJob> jobs);
+
+  [[nodiscard]]
+  unsigned int ThreadCount() const;
+
+private:
+  struct WorkQueue
+  {
+    std::mutex mutex;
+    std::deque<std::size_t> jobs;
+  };
+
+  // Index of the next job for worker, from its own queue or stolen from
+  // another one. Nothing left anywhere once it returns nullopt, jobs are
+  // never added while a batch runs
+  std::optional<std::size_t> NextJob(std::size_t worker);
+
+  BatchResult RunJob(const BatchJob &job);
+
+  // Image of the rom at filePath, mapped by the first job that needs it
+  std::shared_ptr<const RomImage> Image(const std::string &filePath);
+
+  unsigned int _threadCount;
+  // WorkQueue holds a mutex, so queues are kept behind pointers
+  std::vector<std::unique_ptr<WorkQueue>> _queues;
+  // images of the current batch by path
+  std::mutex _imagesMutex;
+  std::map<std::string, std::shared_ptr<const RomImage>> _images;
+};
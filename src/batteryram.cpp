@@ -0,0 +1,111 @@
+#include "batteryram.hpp"
+
+#include <algorithm>
+#include <format>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+BatteryRam::BatteryRam(const std::string &filePath, std::size_t size)
+    : _data{}, _size(size), _file{}
+{
+  HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ | GENERIC_WRITE,
+      FILE_SHARE_READ, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+  {
+    throw std::runtime_error(
+        std::format("Failed to open save file: {}", filePath));
+  }
+  // the mapping grows the file to size if it's shorter
+  LARGE_INTEGER fileSize{};
+  GetFileSizeEx(file, &fileSize);
+  auto mapSize = std::max(static_cast<std::uint64_t>(fileSize.QuadPart),
+      static_cast<std::uint64_t>(size));
+  HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE,
+      static_cast<DWORD>(mapSize >> 32U), static_cast<DWORD>(mapSize),
+      nullptr);
+  if (mapping == nullptr)
+  {
+    CloseHandle(file);
+    throw std::runtime_error(
+        std::format("Failed to map save file: {}", filePath));
+  }
+  void *data = MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, size);
+  CloseHandle(mapping);
+  if (data == nullptr)
+  {
+    CloseHandle(file);
+    throw std::runtime_error(
+        std::format("Failed to map save file: {}", filePath));
+  }
+  _data = static_cast<std::uint8_t *>(data);
+  _file = file;
+}
+
+BatteryRam::~BatteryRam()
+{
+  FlushViewOfFile(_data, _size);
+  UnmapViewOfFile(_data);
+  FlushFileBuffers(_file);
+  CloseHandle(_file);
+}
+
+void BatteryRam::Flush() const
+{
+  FlushViewOfFile(_data, _size);
+}
+#else
+BatteryRam::BatteryRam(const std::string &filePath, std::size_t size)
+    : _data{}, _size(size)
+{
+  int file = open(filePath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if (file == -1)
+  {
+    throw std::runtime_error(
+        std::format("Failed to open save file: {}", filePath));
+  }
+  struct stat status{};
+  if (fstat(file, &status) == -1
+      || (static_cast<std::size_t>(status.st_size) < size
+          && ftruncate(file, static_cast<off_t>(size)) == -1))
+  {
+    close(file);
+    throw std::runtime_error(
+        std::format("Failed to resize save file: {}", filePath));
+  }
+  void *data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+  close(file);
+  if (data == MAP_FAILED)
+  {
+    throw std::runtime_error(
+        std::format("Failed to map save file: {}", filePath));
+  }
+  _data = static_cast<std::uint8_t *>(data);
+}
+
+BatteryRam::~BatteryRam()
+{
+  msync(_data, _size, MS_SYNC);
+  munmap(_data, _size);
+}
+
+void BatteryRam::Flush() const
+{
+  msync(_data, _size, MS_ASYNC);
+}
+#endif
+
+std::span<std::uint8_t> BatteryRam::Data()
+{
+  return {_data, _size};
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+// Battery backed cartridge ram kept in a save file. The file is mapped
+// shared and read write, so the ram is the file: the game writes straight
+// into the page cache and the os writes dirty pages back on its own. Nothing
+// happens on the write path, and the ram survives the process crashing.
+//
+// Flush starts writing changed pages to disk without waiting for it, call it
+// every now and then to bound what an os crash or power loss can lose. The
+// destructor flushes and waits.
+class BatteryRam
+{
+public:
+  // Map size bytes of filePath, the file is created zero filled if it
+  // doesn't exist and grown if it's shorter. Longer files are kept as they
+  // are, some emulators store the clock after the ram. Throws
+  // std::runtime_error if the file can't be mapped
+  BatteryRam(const std::string &filePath, std::size_t size);
+
+  BatteryRam(const BatteryRam &) = delete;
+  BatteryRam &operator=(const BatteryRam &) = delete;
+  BatteryRam(BatteryRam &&) = delete;
+  BatteryRam &operator=(BatteryRam &&) = delete;
+  ~BatteryRam();
+
+  [[nodiscard]]
+  std::span<std::uint8_t> Data();
+
+  void Flush() const;
+
+private:
+  std::uint8_t *_data;
+  std::size_t _size;
+#ifdef _WIN32
+  // kept open to flush the file's buffers on close
+  void *_file;
+#endif
+};
@@ -28,7 +28,7 @@ template <unsigned int N, typename T>
   requires std::unsigned_integral<T> || std::convertible_to<T, unsigned int>
 constexpr T Unset(T &&data)
 {
-  return (data & ~(1U << N));
+  return static_cast<T>(data & ~(1U << N));
 }
 
 template <unsigned int N, typename T>
@@ -6,6 +6,7 @@
 #include <fstream>
 #include <stdexcept>
 #include <string>
+#include <utility>
 
 #include "common.hpp"
 #include "logmanager.hpp"
@@ -37,7 +38,27 @@ void BootRom::Write(std::uint16_t addr, [[maybe_unused]] std::uint8_t data)
       data);
 }
 
+MemoryRange::Storage BootRom::GetStorage()
+{
+  return {};
+}
+
 void BootRom::Load(const std::string &filePath)
 {
   FileMemoryRange::Load(filePath, BootRomOffset);
 }
+
+void BootRom::Load(std::shared_ptr<const RomImage> image)
+{
+  FileMemoryRange::Load(std::move(image), BootRomOffset);
+}
+
+void BootRom::SaveState(SaveStateWriter &writer) const
+{
+  writer.Write(_enabled);
+}
+
+void BootRom::LoadState(SaveStateReader &reader)
+{
+  reader.Read(_enabled);
+}
@@ -8,6 +8,7 @@
 #include "concretememoryrange.hpp"
 #include "filememoryrange.hpp"
 #include "memoryrange.hpp"
+#include "savestate.hpp"
 
 class BootRom : public FileMemoryRange
 {
@@ -19,7 +20,17 @@ public:
 
   void Write(std::uint16_t addr, std::uint8_t data) override;
 
+  // BootRom can be disabled at runtime so it must always be accessed through
+  // Contains/Read
+  [[nodiscard]]
+  Storage GetStorage() override;
+
   void Load(const std::string &filePath);
+  void Load(std::shared_ptr<const RomImage> image);
+
+  // only whether the bootrom is still mapped, the rom itself isn't saved
+  void SaveState(SaveStateWriter &writer) const;
+  void LoadState(SaveStateReader &reader);
 
 private:
   static constexpr int BootRomOffset{0x00};
@@ -0,0 +1,592 @@
+#include "cartridge.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <format>
+#include <stdexcept>
+#include <utility>
+
+#include "logmanager.hpp"
+
+namespace
+{
+constexpr std::size_t CARTRIDGE_TYPE_ADDRESS{0x0147};
+constexpr std::size_t RAM_SIZE_ADDRESS{0x0149};
+
+struct CartridgeType
+{
+  std::uint8_t code;
+  Cartridge::Mbc mbc;
+  bool hasRam;
+  bool hasBattery;
+  bool hasRtc;
+};
+
+// https://gbdev.io/pandocs/The_Cartridge_Header.html#0147--cartridge-type
+constexpr std::array CARTRIDGE_TYPES{
+    CartridgeType{0x00, Cartridge::Mbc::None, false, false, false},
+    CartridgeType{0x01, Cartridge::Mbc::Mbc1, false, false, false},
+    CartridgeType{0x02, Cartridge::Mbc::Mbc1, true, false, false},
+    CartridgeType{0x03, Cartridge::Mbc::Mbc1, true, true, false},
+    CartridgeType{0x08, Cartridge::Mbc::None, true, false, false},
+    CartridgeType{0x09, Cartridge::Mbc::None, true, true, false},
+    CartridgeType{0x0F, Cartridge::Mbc::Mbc3, false, true, true},
+    CartridgeType{0x10, Cartridge::Mbc::Mbc3, true, true, true},
+    CartridgeType{0x11, Cartridge::Mbc::Mbc3, false, false, false},
+    CartridgeType{0x12, Cartridge::Mbc::Mbc3, true, false, false},
+    CartridgeType{0x13, Cartridge::Mbc::Mbc3, true, true, false},
+    CartridgeType{0x19, Cartridge::Mbc::Mbc5, false, false, false},
+    CartridgeType{0x1A, Cartridge::Mbc::Mbc5, true, false, false},
+    CartridgeType{0x1B, Cartridge::Mbc::Mbc5, true, true, false},
+    CartridgeType{0x1C, Cartridge::Mbc::Mbc5, false, false, false},
+    CartridgeType{0x1D, Cartridge::Mbc::Mbc5, true, false, false},
+    CartridgeType{0x1E, Cartridge::Mbc::Mbc5, true, true, false},
+};
+
+// indexed by the ram size code, 0x01 is an unofficial 2 KiB
+constexpr std::array<std::size_t, 6> RAM_SIZES{
+    0, 0x800, 0x2000, 0x8000, 0x20000, 0x10000};
+
+// MBC3 clock register select values
+constexpr std::uint8_t RTC_SECONDS{0x08};
+constexpr std::uint8_t RTC_DAYS_HIGH{0x0C};
+constexpr std::uint8_t RTC_HALT{1U << 6U};
+constexpr std::uint8_t RTC_DAY_CARRY{1U << 7U};
+
+// The clock is saved after the ram the way most emulators do: the live then
+// the latched registers as 32 bit values and the unix time they were saved
+// at as a 64 bit value, all little endian
+constexpr std::size_t RTC_SAVE_SIZE{48};
+constexpr std::size_t RTC_SAVE_REGISTER_SIZE{4};
+constexpr std::size_t RTC_SAVE_TIME_OFFSET{40};
+
+void StoreLittleEndian(
+    std::span<std::uint8_t> out, std::uint64_t value, std::size_t size)
+{
+  for (std::size_t byte{0}; byte < size; ++byte)
+  {
+    out[byte] = static_cast<std::uint8_t>(value >> (8U * byte));
+  }
+}
+
+std::uint64_t LoadLittleEndian(
+    std::span<const std::uint8_t> in, std::size_t size)
+{
+  std::uint64_t value{};
+  for (std::size_t byte{0}; byte < size; ++byte)
+  {
+    value |= static_cast<std::uint64_t>(in[byte]) << (8U * byte);
+  }
+  return value;
+}
+
+std::uint64_t UnixTime()
+{
+  return static_cast<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::seconds>(
+          std::chrono::system_clock::now().time_since_epoch())
+          .count());
+}
+}  // namespace
+
+Cartridge::Cartridge(MemoryManagementUnit &mmu, Scheduler &scheduler,
+    std::shared_ptr<const RomImage> rom)
+    : _mmu(mmu), _scheduler(scheduler), _image(std::move(rom)),
+      _rom(_image->Data()), _state{.rtcLastUpdate = scheduler.Now()}
+{
+  _logger = LogManager::GetLogger("Cartridge");
+  // banks are mapped straight into the image, so it has to hold whole banks
+  if (_rom.size() < 2 * ROM_BANK_SIZE || _rom.size() % ROM_BANK_SIZE != 0)
+  {
+    throw std::runtime_error(std::format(
+        "Rom size must be a multiple of 16 KiB, got {} bytes", _rom.size()));
+  }
+  _romBankCount = _rom.size() / ROM_BANK_SIZE;
+
+  auto typeCode = _rom[CARTRIDGE_TYPE_ADDRESS];
+  auto type = std::ranges::find(CARTRIDGE_TYPES, typeCode,
+      [](const CartridgeType &entry) { return entry.code; });
+  if (type == std::ranges::end(CARTRIDGE_TYPES))
+  {
+    throw std::runtime_error(
+        std::format("Unsupported cartridge type: {:#04X}", typeCode));
+  }
+  _mbc = type->mbc;
+  _hasBattery = type->hasBattery;
+  _hasRtc = type->hasRtc;
+
+  auto ramSizeCode = _rom[RAM_SIZE_ADDRESS];
+  if (ramSizeCode >= RAM_SIZES.size())
+  {
+    throw std::runtime_error(
+        std::format("Unsupported ram size: {:#04X}", ramSizeCode));
+  }
+  if (type->hasRam)
+  {
+    _volatileRam.resize(RAM_SIZES[ramSizeCode]);
+  }
+  _ram = _volatileRam;
+  _ramBankCount = std::max<std::size_t>(_ram.size() / RAM_BANK_SIZE, 1);
+
+  LOG_INFO(_logger, "Cartridge type: {:#04X}, {} rom banks, {} bytes of ram",
+      typeCode, _romBankCount, _ram.size());
+  UpdateBanks(true);
+}
+
+bool Cartridge::Contains(std::uint16_t addr) const
+{
+  return addr < ROM_END_ADDRESS
+         || (addr >= RAM_START_ADDRESS && addr < RAM_END_ADDRESS);
+}
+
+std::uint8_t Cartridge::Read(std::uint16_t addr) const
+{
+  if (addr < ROM_BANK_ADDRESS)
+  {
+    return _rom[_romBank0Offset + addr];
+  }
+  if (addr < ROM_END_ADDRESS)
+  {
+    return _rom[_romBankOffset + (addr - ROM_BANK_ADDRESS)];
+  }
+  if (_ramMapped)
+  {
+    return _ram[RamOffset(addr)];
+  }
+  if (IsRtcMapped())
+  {
+    return ReadRtc();
+  }
+  return 0xFF;
+}
+
+void Cartridge::Write(std::uint16_t addr, std::uint8_t data)
+{
+  if (addr < ROM_END_ADDRESS)
+  {
+    WriteRegister(addr, data);
+    return;
+  }
+  if (_ramMapped)
+  {
+    _ram[RamOffset(addr)] = data;
+    return;
+  }
+  if (!IsRtcMapped())
+  {
+    return;
+  }
+
+  // writes go to the live clock, the latched copy keeps its value
+  CatchUpRtc();
+  auto &rtc = _state.rtc;
+  switch (_state.ramBank)
+  {
+  case RTC_SECONDS:
+    rtc.seconds = static_cast<std::uint8_t>(data & 0x3FU);
+    // writing the seconds restarts the current second
+    _state.rtcLastUpdate = _scheduler.Now();
+    break;
+  case RTC_SECONDS + 1:
+    rtc.minutes = static_cast<std::uint8_t>(data & 0x3FU);
+    break;
+  case RTC_SECONDS + 2:
+    rtc.hours = static_cast<std::uint8_t>(data & 0x1FU);
+    break;
+  case RTC_SECONDS + 3:
+    rtc.daysLow = data;
+    break;
+  default:
+    rtc.daysHigh =
+        static_cast<std::uint8_t>(data & (RTC_DAY_CARRY | RTC_HALT | 0x01U));
+    break;
+  }
+}
+
+std::uint8_t &Cartridge::Address(std::uint16_t addr)
+{
+  if (addr >= RAM_START_ADDRESS && _ramMapped)
+  {
+    return _ram[RamOffset(addr)];
+  }
+  // rom can't be changed in place and writes to it set mapper registers,
+  // they have to go through Write. The cpu does that for every write,
+  // including the read-modify-write of CB operations on (HL), so a change
+  // to this copy is dropped on purpose
+  _unmapped = Read(addr);
+  return _unmapped;
+}
+
+void Cartridge::MapBanks()
+{
+  UpdateBanks(true);
+}
+
+Cartridge::Mbc Cartridge::GetMbc() const
+{
+  return _mbc;
+}
+
+bool Cartridge::UseSaveFile(const std::string &filePath)
+{
+  if (!_hasBattery || (_ram.empty() && !_hasRtc))
+  {
+    return false;
+  }
+  auto ramSize = _ram.size();
+  auto batteryRam = std::make_unique<BatteryRam>(
+      filePath, ramSize + (_hasRtc ? RTC_SAVE_SIZE : 0));
+  _ram = batteryRam->Data().first(ramSize);
+  _rtcSave = batteryRam->Data().subspan(ramSize);
+  _batteryRam = std::move(batteryRam);
+  _volatileRam = {};
+  // the ram moved, the mmu has to point at the file
+  UpdateBanks(true);
+  LoadRtc();
+  LOG_INFO(_logger, "Keeping cartridge ram in {}", filePath);
+  return true;
+}
+
+void Cartridge::FlushSaveFile()
+{
+  if (_batteryRam != nullptr)
+  {
+    StoreRtc();
+    _batteryRam->Flush();
+  }
+}
+
+void Cartridge::SaveState(SaveStateWriter &writer) const
+{
+  writer.Write(_state);
+  writer.WriteMemory(_ram);
+}
+
+void Cartridge::LoadState(SaveStateReader &reader)
+{
+  reader.Read(_state);
+  reader.ReadMemory(_ram);
+  UpdateBanks(true);
+}
+
+// https://gbdev.io/pandocs/MBC1.html, https://gbdev.io/pandocs/MBC3.html and
+// https://gbdev.io/pandocs/MBC5.html
+void Cartridge::WriteRegister(std::uint16_t addr, std::uint8_t data)
+{
+  auto region = addr >> 13U;  // 0x2000 byte regions of the rom
+  switch (_mbc)
+  {
+  case Mbc::None:
+    return;
+  case Mbc::Mbc1:
+    if (region == 0)
+    {
+      _state.ramEnabled = (data & 0x0FU) == 0x0A;
+    }
+    else if (region == 1)
+    {
+      _state.romBank = static_cast<std::uint16_t>(data & 0x1FU);
+    }
+    else if (region == 2)
+    {
+      _state.ramBank = static_cast<std::uint8_t>(data & 0x03U);
+    }
+    else
+    {
+      _state.bankingMode = (data & 0x01U) != 0;
+    }
+    break;
+  case Mbc::Mbc3:
+    if (region == 0)
+    {
+      _state.ramEnabled = (data & 0x0FU) == 0x0A;
+    }
+    else if (region == 1)
+    {
+      _state.romBank = static_cast<std::uint16_t>(data & 0x7FU);
+    }
+    else if (region == 2)
+    {
+      _state.ramBank = data;
+    }
+    else
+    {
+      if (_state.latch == 0x00 && data == 0x01 && _hasRtc)
+      {
+        CatchUpRtc();
+        _state.latchedRtc = _state.rtc;
+      }
+      _state.latch = data;
+    }
+    break;
+  case Mbc::Mbc5:
+    if (region == 0)
+    {
+      _state.ramEnabled = data == 0x0A;
+    }
+    else if (region == 1 && addr < 0x3000)
+    {
+      _state.romBank =
+          static_cast<std::uint16_t>((_state.romBank & 0x100U) | data);
+    }
+    else if (region == 1)
+    {
+      _state.romBank = static_cast<std::uint16_t>(
+          (_state.romBank & 0xFFU) | ((data & 0x01U) << 8U));
+    }
+    else if (region == 2)
+    {
+      _state.ramBank = static_cast<std::uint8_t>(data & 0x0FU);
+    }
+    break;
+  }
+  UpdateBanks(false);
+}
+
+void Cartridge::UpdateBanks(bool force)
+{
+  std::size_t romBank0{0};
+  std::size_t romBank{_state.romBank};
+  std::size_t ramBank{0};
+  switch (_mbc)
+  {
+  case Mbc::None:
+    romBank = 1;
+    break;
+  case Mbc::Mbc1:
+    // bank 0 can't be selected in the 5 bit register, the upper bits still
+    // apply so 0x20, 0x40 and 0x60 become 0x21, 0x41 and 0x61
+    romBank = std::max<std::size_t>(romBank, 1) | (_state.ramBank << 5U);
+    if (_state.bankingMode)
+    {
+      romBank0 = std::size_t{_state.ramBank} << 5U;
+      ramBank = _state.ramBank;
+    }
+    break;
+  case Mbc::Mbc3:
+    romBank = std::max<std::size_t>(romBank, 1);
+    ramBank = _state.ramBank & 0x03U;
+    break;
+  case Mbc::Mbc5:
+    ramBank = _state.ramBank;
+    break;
+  }
+
+  auto romBank0Offset = (romBank0 % _romBankCount) * ROM_BANK_SIZE;
+  auto romBankOffset = (romBank % _romBankCount) * ROM_BANK_SIZE;
+  auto ramBankOffset = (ramBank % _ramBankCount) * RAM_BANK_SIZE;
+  auto ramMapped = IsRamMapped();
+
+  if (force || romBank0Offset != _romBank0Offset)
+  {
+    _romBank0Offset = romBank0Offset;
+    _mmu.MapPages(
+        *this, 0x0000, ROM_BANK_SIZE, _rom.data() + _romBank0Offset, nullptr);
+  }
+  if (force || romBankOffset != _romBankOffset)
+  {
+    _romBankOffset = romBankOffset;
+    _mmu.MapPages(*this, ROM_BANK_ADDRESS, ROM_BANK_SIZE,
+        _rom.data() + _romBankOffset, nullptr);
+  }
+  if (force || ramBankOffset != _ramBankOffset || ramMapped != _ramMapped)
+  {
+    _ramBankOffset = ramBankOffset;
+    _ramMapped = ramMapped;
+    // ram smaller than the window (2 KiB) is mirrored by the slow path
+    auto *ram = _ramMapped ? _ram.data() + _ramBankOffset : nullptr;
+    _mmu.MapPages(*this, RAM_START_ADDRESS,
+        std::min(_ram.size(), RAM_BANK_SIZE), ram, ram);
+    if (!_ramMapped)
+    {
+      _mmu.MapPages(*this, RAM_START_ADDRESS, RAM_BANK_SIZE, nullptr, nullptr);
+    }
+  }
+}
+
+bool Cartridge::IsRamMapped() const
+{
+  if (_ram.empty())
+  {
+    return false;
+  }
+  if (_mbc == Mbc::None)
+  {
+    return true;
+  }
+  // MBC3 register values 0x08 and up select a clock register instead
+  return _state.ramEnabled && (_mbc != Mbc::Mbc3 || _state.ramBank < 0x08);
+}
+
+bool Cartridge::IsRtcMapped() const
+{
+  return _hasRtc && _state.ramEnabled && _state.ramBank >= RTC_SECONDS
+         && _state.ramBank <= RTC_DAYS_HIGH;
+}
+
+std::uint8_t Cartridge::ReadRtc() const
+{
+  // reads see the clock as it was last latched
+  const auto &rtc = _state.latchedRtc;
+  switch (_state.ramBank)
+  {
+  case RTC_SECONDS:
+    return rtc.seconds;
+  case RTC_SECONDS + 1:
+    return rtc.minutes;
+  case RTC_SECONDS + 2:
+    return rtc.hours;
+  case RTC_SECONDS + 3:
+    return rtc.daysLow;
+  default:
+    return rtc.daysHigh;
+  }
+}
+
+std::size_t Cartridge::RamOffset(std::uint16_t addr) const
+{
+  auto window = std::min(_ram.size(), RAM_BANK_SIZE);
+  return _ramBankOffset + (addr - RAM_START_ADDRESS) % window;
+}
+
+void Cartridge::CatchUpRtc()
+{
+  auto seconds =
+      (_scheduler.Now() - _state.rtcLastUpdate) / RTC_CYCLES_PER_SECOND;
+  _state.rtcLastUpdate += seconds * RTC_CYCLES_PER_SECOND;
+  if ((_state.rtc.daysHigh & RTC_HALT) == 0)
+  {
+    AdvanceRtc(seconds);
+  }
+}
+
+void Cartridge::LoadRtc()
+{
+  if (_rtcSave.empty())
+  {
+    return;
+  }
+  auto savedAt = LoadLittleEndian(
+      _rtcSave.subspan(RTC_SAVE_TIME_OFFSET), sizeof(std::uint64_t));
+  if (savedAt == 0)
+  {
+    // new save file, the clock starts where it is
+    return;
+  }
+  auto load = [this](Rtc &rtc, std::size_t offset) {
+    auto reg = [&](std::size_t index) {
+      return static_cast<std::uint8_t>(LoadLittleEndian(
+          _rtcSave.subspan(offset + (index * RTC_SAVE_REGISTER_SIZE)),
+          RTC_SAVE_REGISTER_SIZE));
+    };
+    rtc.seconds = static_cast<std::uint8_t>(reg(0) & 0x3FU);
+    rtc.minutes = static_cast<std::uint8_t>(reg(1) & 0x3FU);
+    rtc.hours = static_cast<std::uint8_t>(reg(2) & 0x1FU);
+    rtc.daysLow = reg(3);
+    rtc.daysHigh = static_cast<std::uint8_t>(
+        reg(4) & (RTC_DAY_CARRY | RTC_HALT | 0x01U));
+  };
+  load(_state.rtc, 0);
+  load(_state.latchedRtc, 5 * RTC_SAVE_REGISTER_SIZE);
+  _state.rtcLastUpdate = _scheduler.Now();
+
+  // the clock kept running while the game was off
+  auto now = UnixTime();
+  if (now > savedAt && (_state.rtc.daysHigh & RTC_HALT) == 0)
+  {
+    AdvanceRtc(now - savedAt);
+  }
+}
+
+void Cartridge::StoreRtc()
+{
+  if (_rtcSave.empty())
+  {
+    return;
+  }
+  CatchUpRtc();
+  auto store = [this](const Rtc &rtc, std::size_t offset) {
+    std::size_t index{0};
+    for (auto reg :
+        {rtc.seconds, rtc.minutes, rtc.hours, rtc.daysLow, rtc.daysHigh})
+    {
+      StoreLittleEndian(
+          _rtcSave.subspan(offset + (index++ * RTC_SAVE_REGISTER_SIZE)), reg,
+          RTC_SAVE_REGISTER_SIZE);
+    }
+  };
+  store(_state.rtc, 0);
+  store(_state.latchedRtc, 5 * RTC_SAVE_REGISTER_SIZE);
+  StoreLittleEndian(_rtcSave.subspan(RTC_SAVE_TIME_OFFSET), UnixTime(),
+      sizeof(std::uint64_t));
+}
+
+void Cartridge::AdvanceRtc(std::uint64_t seconds)
+{
+  auto &rtc = _state.rtc;
+  // registers written out of range count up to their bit width before they
+  // wrap, without carrying. Tick one second at a time until they're back in
+  // range, after that the seconds can be added in one go
+  while (seconds > 0
+         && (rtc.seconds >= 60 || rtc.minutes >= 60 || rtc.hours >= 24))
+  {
+    TickRtc();
+    --seconds;
+  }
+  if (seconds == 0)
+  {
+    return;
+  }
+
+  std::uint64_t days = rtc.daysLow | ((rtc.daysHigh & 0x01U) << 8U);
+  auto total =
+      seconds + rtc.seconds + 60 * (rtc.minutes + 60 * (rtc.hours + 24 * days));
+  rtc.seconds = static_cast<std::uint8_t>(total % 60);
+  total /= 60;
+  rtc.minutes = static_cast<std::uint8_t>(total % 60);
+  total /= 60;
+  rtc.hours = static_cast<std::uint8_t>(total % 24);
+  days = total / 24;
+  if (days > 0x1FF)
+  {
+    rtc.daysHigh |= RTC_DAY_CARRY;
+  }
+  rtc.daysLow = static_cast<std::uint8_t>(days & 0xFFU);
+  rtc.daysHigh = static_cast<std::uint8_t>(
+      (rtc.daysHigh & ~0x01U) | ((days >> 8U) & 0x01U));
+}
+
+void Cartridge::TickRtc()
+{
+  auto &rtc = _state.rtc;
+  rtc.seconds = static_cast<std::uint8_t>((rtc.seconds + 1U) & 0x3FU);
+  if (rtc.seconds != 60)
+  {
+    return;
+  }
+  rtc.seconds = 0;
+  rtc.minutes = static_cast<std::uint8_t>((rtc.minutes + 1U) & 0x3FU);
+  if (rtc.minutes != 60)
+  {
+    return;
+  }
+  rtc.minutes = 0;
+  rtc.hours = static_cast<std::uint8_t>((rtc.hours + 1U) & 0x1FU);
+  if (rtc.hours != 24)
+  {
+    return;
+  }
+  rtc.hours = 0;
+  if (++rtc.daysLow != 0)
+  {
+    return;
+  }
+  if ((rtc.daysHigh & 0x01U) == 0)
+  {
+    rtc.daysHigh |= 0x01U;
+    return;
+  }
+  rtc.daysHigh =
+      static_cast<std::uint8_t>((rtc.daysHigh & ~0x01U) | RTC_DAY_CARRY);
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <spdlog/logger.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "batteryram.hpp"
+#include "memoryrange.hpp"
+#include "mmu.hpp"
+#include "romimage.hpp"
+#include "savestate.hpp"
+#include "scheduler.hpp"
+
+// Game cartridge: rom at 0x0000 - 0x7FFF and external ram at 0xA000 - 0xBFFF,
+// with the memory bank controller the header asks for (none, MBC1, MBC3 with
+// its real time clock, or MBC5).
+//
+// Banks are never copied. A bank switch repoints the mmu pages of the rom
+// and ram windows at the selected bank of the rom image and ram, so reads
+// and ram writes stay on the mmu fast path. Only writes to rom (the mapper
+// registers), disabled ram and the clock registers reach the cartridge.
+class Cartridge : public MemoryRange
+{
+public:
+  constexpr static std::size_t ROM_BANK_SIZE{0x4000};
+  constexpr static std::size_t RAM_BANK_SIZE{0x2000};
+  constexpr static std::uint16_t RAM_START_ADDRESS{0xA000};
+
+  enum class Mbc : std::uint8_t
+  {
+    None,
+    Mbc1,
+    Mbc3,
+    Mbc5
+  };
+
+  // Parses the header of rom, throws std::runtime_error for cartridge types
+  // and sizes that aren't supported
+  Cartridge(MemoryManagementUnit &mmu, Scheduler &scheduler,
+      std::shared_ptr<const RomImage> rom);
+
+  [[nodiscard]]
+  bool Contains(std::uint16_t addr) const override;
+  [[nodiscard]]
+  std::uint8_t Read(std::uint16_t addr) const override;
+  void Write(std::uint16_t addr, std::uint8_t data) override;
+  // Rom and clock registers hand out a copy, writes through it are lost
+  std::uint8_t &Address(std::uint16_t addr) override;
+
+  // Point the mmu at the selected banks, call once after registering the
+  // cartridge. Bank switches keep the mapping up to date afterwards
+  void MapBanks();
+
+  [[nodiscard]]
+  Mbc GetMbc() const;
+
+  // Keep the ram in the save file at filePath from now on, its contents
+  // replace the ram, so call it before running. An MBC3 clock is kept after
+  // the ram and has run on by the time passed since it was saved. Returns
+  // false if the cartridge has neither battery backed ram nor a clock
+  bool UseSaveFile(const std::string &filePath);
+
+  // Store the clock in the save file and start writing everything changed
+  // since the last flush, without waiting for it. The clock is only stored
+  // here, call it before exiting. Does nothing without a save file
+  void FlushSaveFile();
+
+  void SaveState(SaveStateWriter &writer) const;
+  void LoadState(SaveStateReader &reader);
+
+private:
+  // MBC3 clock registers, as the game sees them
+  struct Rtc
+  {
+    std::uint8_t seconds;
+    std::uint8_t minutes;
+    std::uint8_t hours;
+    // low 8 bits of the day counter
+    std::uint8_t daysLow;
+    // bit 0: bit 8 of the day counter, bit 6: halt, bit 7: day overflow
+    std::uint8_t daysHigh;
+  };
+
+  struct State
+  {
+    // cycle the clock was last caught up to
+    std::uint64_t rtcLastUpdate;
+    // bank register as written: 5 bits on MBC1, 7 on MBC3, 9 on MBC5
+    std::uint16_t romBank{1};
+    // MBC1: the 2 bit register (ram bank or upper rom bank bits)
+    // MBC3: ram bank 0x00 - 0x03 or clock register 0x08 - 0x0C
+    // MBC5: ram bank 0x00 - 0x0F
+    std::uint8_t ramBank{};
+    bool ramEnabled{};
+    // MBC1 banking mode, the 2 bit register also banks 0x0000 and ram
+    bool bankingMode{};
+    // MBC3 last write to the latch register, 0 then 1 latches the clock
+    std::uint8_t latch{0xFF};
+    Rtc rtc{};
+    Rtc latchedRtc{};
+  };
+
+  constexpr static std::uint16_t ROM_BANK_ADDRESS{0x4000};
+  constexpr static std::uint16_t ROM_END_ADDRESS{0x8000};
+  constexpr static std::uint16_t RAM_END_ADDRESS{0xC000};
+  constexpr static std::uint64_t RTC_CYCLES_PER_SECOND{4194304};
+
+  void WriteRegister(std::uint16_t addr, std::uint8_t data);
+  // Recompute the bank offsets from the registers and remap the windows that
+  // moved, all of them if force is set
+  void UpdateBanks(bool force);
+
+  // true if 0xA000 - 0xBFFF currently shows ram (and not the clock)
+  [[nodiscard]]
+  bool IsRamMapped() const;
+  // true if 0xA000 - 0xBFFF currently shows a clock register
+  [[nodiscard]]
+  bool IsRtcMapped() const;
+  // selected register of the latched clock
+  [[nodiscard]]
+  std::uint8_t ReadRtc() const;
+  [[nodiscard]]
+  std::size_t RamOffset(std::uint16_t addr) const;
+
+  // clock from and to the save file, see UseSaveFile
+  void LoadRtc();
+  void StoreRtc();
+  void CatchUpRtc();
+  void AdvanceRtc(std::uint64_t seconds);
+  void TickRtc();
+
+  MemoryManagementUnit &_mmu;
+  Scheduler &_scheduler;
+  std::shared_ptr<const RomImage> _image;
+  std::span<const std::uint8_t> _rom;
+  // ram as long as there's no save file
+  std::vector<std::uint8_t> _volatileRam;
+  std::unique_ptr<BatteryRam> _batteryRam;
+  // whichever of the two holds the ram
+  std::span<std::uint8_t> _ram;
+  // clock in the save file, empty without one
+  std::span<std::uint8_t> _rtcSave;
+  Mbc _mbc;
+  bool _hasBattery;
+  bool _hasRtc;
+  std::size_t _romBankCount;
+  std::size_t _ramBankCount;
+  State _state;
+
+  // derived from _state by UpdateBanks
+  std::size_t _romBank0Offset{};
+  std::size_t _romBankOffset{};
+  std::size_t _ramBankOffset{};
+  bool _ramMapped{};
+
+  // handed out by Address for rom and clock registers
+  std::uint8_t _unmapped{0xFF};
+  std::shared_ptr<spdlog::logger> _logger;
+};
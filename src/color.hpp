@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
 struct Color
 {
@@ -8,3 +9,18 @@ struct Color
   std::uint8_t blue;
   std::uint8_t alpha;
 };
+
+// Colors of the 4 dmg shades, from lightest (0) to darkest (3)
+constexpr std::array<Color, 4> SHADE_COLORS{{
+    {.red = 0xe0, .green = 0xf0, .blue = 0xe7, .alpha = 0xff},
+    {.red = 0x8b, .green = 0xa3, .blue = 0x94, .alpha = 0xff},
+    {.red = 0x55, .green = 0x64, .blue = 0x5a, .alpha = 0xff},
+    {.red = 0x34, .green = 0x3d, .blue = 0x37, .alpha = 0xff},
+}};
+
+// Map a 2 bit color id through a palette register (BGP, OBP0, OBP1), each
+// color id picks 2 bits of the palette as its shade
+constexpr std::uint8_t PaletteShade(std::uint8_t palette, std::uint8_t colorId)
+{
+  return static_cast<std::uint8_t>((palette >> (colorId * 2U)) & 0x3U);
+}
@@ -13,6 +13,11 @@ constexpr std::uint16_t SCX_REGISTER_ADDRESS{0xFF43};
 constexpr std::uint16_t BGP_REGISTER_ADDRESS{0xFF47};
 constexpr std::uint16_t OBP0_REGISTER_ADDRESS{0xFF48};
 constexpr std::uint16_t OBP1_REGISTER_ADDRESS{0xFF49};
+constexpr std::uint16_t DMA_REGISTER_ADDRESS{0xFF46};
+constexpr std::uint16_t WY_REGISTER_ADDRESS{0xFF4A};
+constexpr std::uint16_t WX_REGISTER_ADDRESS{0xFF4B};
+constexpr std::uint16_t VRAM_SIZE{0x2000};
+constexpr std::uint16_t VRAM_START_ADDRESS{0x8000};
 
 constexpr std::uint16_t BG_WIN_TILEMAP_ADDRESS0{0x9800};
 constexpr std::uint16_t BG_WIN_TILEMAP_ADDRESS1{0x9C00};
@@ -25,7 +30,12 @@ constexpr std::uint16_t BG_WIN_TILEDATA_ADDRESS1{
 constexpr unsigned int BG_WIN_TILEMAP_ROW_SIZE{32};
 
 constexpr unsigned int TILE_DATA_SIZE{16};  // each tile takes 16 bytes
+constexpr unsigned int TILE_COUNT{384};      // tiles in 0x8000 - 0x97FF
+constexpr std::uint16_t TILE_DATA_END_ADDRESS{0x9800};
 constexpr unsigned int MAX_DOTS_PER_SCANLINE{456};
+constexpr unsigned int OAM_SEARCH_DOTS{80};
+constexpr unsigned int SCREEN_WIDTH{160};
+constexpr unsigned int SCREEN_HEIGHT{144};
 
 constexpr unsigned int BOOTROM_ENABLE_ADDRESS{
     0xFF50};  // writing to this address disable's bootrom
@@ -44,3 +54,6 @@ constexpr std::uint16_t DIV{0xFF04};
 constexpr std::uint16_t TIMA{0xFF05};
 constexpr std::uint16_t TMA{0xFF06};
 constexpr std::uint16_t TAC{0xFF07};
+
+// Joypad address
+constexpr std::uint16_t JOYPAD_REGISTER_ADDRESS{0xFF00};
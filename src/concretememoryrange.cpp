@@ -21,7 +21,7 @@ bool ConcreteMemoryRange::Contains(std::uint16_t addr) const
 std::uint8_t ConcreteMemoryRange::Read(std::uint16_t addr) const
 {
   // return data from memroy if memory range contains the address
-  if (Contains(addr))
+  if (ConcreteMemoryRange::Contains(addr))
   {
     // adjust address by substracting the offset
     return _memory[addr - _offset];
@@ -34,7 +34,7 @@ std::uint8_t ConcreteMemoryRange::Read(std::uint16_t addr) const
 void ConcreteMemoryRange::Write(std::uint16_t addr, std::uint8_t data)
 {
   // write to memory only if address is contained in memory range
-  if (Contains(addr))
+  if (ConcreteMemoryRange::Contains(addr))
   {
     // adjust the addr by substracting the offset
     _memory[addr - _offset] = data;
@@ -44,14 +44,31 @@ void ConcreteMemoryRange::Write(std::uint16_t addr, std::uint8_t data)
 std::uint8_t &ConcreteMemoryRange::Address(std::uint16_t addr)
 {
   // return data from memroy if memory range contains the address
-  if (Contains(addr))
+  if (ConcreteMemoryRange::Contains(addr))
   {
     // adjust address by substracting the offset
     return _memory[addr - _offset];
   }
 
   // return dummy value if memory range does not contain addr
-  static std::uint8_t dummy;
-  dummy = 0xFF;
-  return dummy;
+  _unmapped = 0xFF;
+  return _unmapped;
+}
+
+MemoryRange::Storage ConcreteMemoryRange::GetStorage()
+{
+  return {.data = _memory.data(),
+      .offset = _offset,
+      .size = _memory.size(),
+      .writable = true};
+}
+
+void ConcreteMemoryRange::SaveState(SaveStateWriter &writer) const
+{
+  writer.WriteMemory(_memory);
+}
+
+void ConcreteMemoryRange::LoadState(SaveStateReader &reader)
+{
+  reader.ReadMemory(_memory);
 }
@@ -2,6 +2,7 @@
 #include <vector>
 
 #include "memoryrange.hpp"
+#include "savestate.hpp"
 
 class ConcreteMemoryRange : public MemoryRange
 {
@@ -20,7 +21,15 @@ public:
 
   std::uint8_t &Address(std::uint16_t addr) override;
 
+  [[nodiscard]]
+  Storage GetStorage() override;
+
+  virtual void SaveState(SaveStateWriter &writer) const;
+  virtual void LoadState(SaveStateReader &reader);
+
 private:
   std::vector<std::uint8_t> _memory;
   std::size_t _offset;
+  // byte handed out by Address for addresses outside the range
+  std::uint8_t _unmapped{0xFF};
 };
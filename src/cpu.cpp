@@ -2,6 +2,7 @@
 
 #include <spdlog/spdlog.h>
 
+#include <array>
 #include <format>
 #include <memory>
 #include <utility>
@@ -10,69 +11,174 @@
 #include "common.hpp"
 #include "logmanager.hpp"
 
+#if defined(__GNUC__) || defined(__clang__)
+#define GB_ALWAYS_INLINE [[gnu::always_inline]] inline
+#elif defined(_MSC_VER)
+#define GB_ALWAYS_INLINE __forceinline
+#else
+#define GB_ALWAYS_INLINE inline
+#endif
+
 // NOLINTBEGIN(readability-suspicious-call-argument, hicpp-signed-bitwise,
 // readability-convert-member-functions-to-static)
 
 Cpu::Cpu(MemoryManagementUnit &mmu)
-    : _state{}, _mmu(mmu), _halted(false), _haltBug(false)
+    : _state{}, _interrupt(std::make_shared<Interrupt>()), _mmu(mmu)
 {
-  _state._interrupt = std::make_shared<Interrupt>();
-  _mmu.AddMemoryRange(_state._interrupt);
+  _mmu.AddMemoryRange(_interrupt);
   _logger = LogManager::GetLogger("Cpu");
 }
 
 Cpu::Cpu(CpuState state, MemoryManagementUnit &mmu)
-    : _state(std::move(state)), _mmu(mmu), _halted(false), _haltBug(false)
+    : _state(state), _interrupt(std::make_shared<Interrupt>()), _mmu(mmu)
 {
-  if (!_state._interrupt)
-  {
-    _state._interrupt = std::make_shared<Interrupt>();
-  }
-  _mmu.AddMemoryRange(_state._interrupt);
+  _mmu.AddMemoryRange(_interrupt);
   _logger = LogManager::GetLogger("Cpu");
 }
 
 [[nodiscard]]
 CpuState Cpu::GetCpuState() const
 {
-  return _state;
+  CpuState state{_state};
+  state.AF.low = Flags();
+  return state;
 }
 
-// TODO: Implement HALT BUG
-int Cpu::Tick()
+void Cpu::SaveState(SaveStateWriter &writer) const
+{
+  writer.Write(GetCpuState());
+  _interrupt->SaveState(writer);
+}
+
+void Cpu::LoadState(SaveStateReader &reader)
+{
+  reader.Read(_state);
+  _deferredFlags.op = FlagOp::None;
+  _interrupt->LoadState(reader);
+}
+
+void Cpu::TraceState() const
 {
   LOG_TRACE(_logger,
       "A:{:02X} F:{:02X} B:{:02X} C:{:02X} D:{:02X} E:{:02X} H:{:02X} L:{:02X} SP:{:04X} PC:{:04X} PCMEM:{:02X},{:02X},{:02X},{:02X}",
-      _state.AF.high, _state.AF.low, _state.BC.high, _state.BC.low,
+      _state.AF.high, Flags(), _state.BC.high, _state.BC.low,
       _state.DE.high, _state.DE.low, _state.HL.high, _state.HL.low,
       _state.SP.reg, _state.PC.reg, _mmu.Read(_state.PC.reg),
       _mmu.Read(_state.PC.reg + 1), _mmu.Read(_state.PC.reg + 2),
       _mmu.Read(_state.PC.reg + 3));
+}
+
+GB_ALWAYS_INLINE bool Cpu::NeedsInterruptCheck(std::uint8_t opcode) const
+{
+  // LD (BC), A ... LD (HL-), A, LD (u16), SP, INC/DEC (HL), LD (HL), u8,
+  // LD (HL), r, PUSH, CALL, RST, LDH (u8), A, LD (C), A, LD (u16), A, which
+  // write memory, and STOP, HALT, DI, EI, RETI
+  constexpr static auto INTERRUPT_CHECKS = [] {
+    std::array<bool, OPCODE_COUNT> checks{};
+    for (auto opcode : {0x02, 0x08, 0x10, 0x12, 0x22, 0x32, 0x34, 0x35, 0x36,
+             0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x76, 0x77, 0xC4, 0xC5, 0xCC,
+             0xCD, 0xD4, 0xD5, 0xD9, 0xDC, 0xE0, 0xE2, 0xE5, 0xEA, 0xF3, 0xF5,
+             0xFB})
+    {
+      checks[static_cast<std::size_t>(opcode)] = true;
+    }
+    for (std::size_t opcode{0xC7}; opcode < OPCODE_COUNT; opcode += 8)
+    {
+      checks[opcode] = true;
+    }
+    return checks;
+  }();
+
+  if (opcode == 0xCB)
+  {
+    // all but BIT write their operand back, only (HL) is in memory
+    auto extended = _mmu.Read(static_cast<std::uint16_t>(_state.PC.reg - 1));
+    return (extended & 0x07) == 0x06 && (extended & 0xC0) != 0x40;
+  }
+  return INTERRUPT_CHECKS[opcode];
+}
 
-  if (_halted)
+// TODO: Implement HALT BUG
+int Cpu::Tick()
+{
+  if (!StartInstruction())
   {
-    if ((_state._interrupt->_ie & _state._interrupt->_if & 0x1F) != 0x00)
+    // If cpu is halted don't increment the PC
+    // return 4Ticks so other components like timer, ppu keep running
+    return HALTED_TICK_CYCLES;
+  }
+
+  return Dispatch(FetchOpcode());
+}
+
+void Cpu::RunUntilInterruptCheck(Scheduler &scheduler)
+{
+  if (!StartInstruction())
+  {
+    scheduler.Advance(HALTED_TICK_CYCLES);
+    return;
+  }
+
+  auto opcode = FetchOpcode();
+  while (true)
+  {
+    scheduler.Advance(Dispatch(opcode));
+    if (NeedsInterruptCheck(opcode) || _backwardJump || scheduler.IsEventDue())
     {
-      _halted = false;
+      return;
+    }
+    // nothing that could wake the cpu up or make it take an interrupt
+    // happened, go straight to the next instruction
+    TraceState();
+    opcode = _mmu.Read(_state.PC.reg++);
+  }
+}
+
+bool Cpu::StartInstruction()
+{
+  TraceState();
+
+  if (_state.halted)
+  {
+    if ((_interrupt->_ie & _interrupt->_if & 0x1F) != 0x00)
+    {
+      _state.halted = false;
     }
     else
     {
-      // If cpu is halted don't increment the PC
-      // return 4Ticks so other components like timer, ppu keep running
-      return 4;
+      return false;
     }
   }
 
-  if (_state._interrupt->_enableRequested)
+  if (_interrupt->_enableRequested)
   {
-    _state._interrupt->_enableRequested = false;
-    _state._interrupt->_ime = true;
+    _interrupt->_enableRequested = false;
+    _interrupt->_ime = true;
     LOG_DEBUG(_logger, "Interrupt enabled");
   }
   HandleInterruptsIfAny();
+  return true;
+}
 
-  auto opcode = FetchOpcode();
+template <typename Operation>
+GB_ALWAYS_INLINE int Cpu::ModifyHl(Operation operation)
+{
+  auto data = _mmu.Read(_state.HL.reg);
+  auto cycles = operation(data);
+  _mmu.Write(_state.HL.reg, data);
+  return cycles;
+}
+
+int Cpu::TickExtended()
+{
+  return DispatchExtended(_mmu.Read(_state.PC.reg++));
+}
 
+// Decode and execute a single opcode. This is forced inline into the per
+// opcode handlers (see Dispatch), where opcode is a constant, so each handler
+// compiles down to just the instruction it executes.
+GB_ALWAYS_INLINE int Cpu::Execute(std::uint8_t opcode)
+{
   switch (opcode)
   {
     case 0x00:
@@ -546,6 +652,7 @@ int Cpu::Tick()
       return LdhAU8();
     case 0xF1:
     {
+      _deferredFlags.op = FlagOp::None;
       int cycles = PopRr(_state.AF);
       _state.AF.low &= 0xF0U;  // clear unused lower nibble
       return cycles;
@@ -555,6 +662,7 @@ int Cpu::Tick()
     case 0xF3:
       return Di();
     case 0xF5:
+      MaterializeFlags();
       return PushRr(_state.AF);
     case 0xF6:
       return OrU8();
@@ -580,10 +688,8 @@ int Cpu::Tick()
   return 0x00;
 }
 
-int Cpu::TickExtended()
+GB_ALWAYS_INLINE int Cpu::ExecuteExtended(std::uint8_t opcode)
 {
-  auto opcode = _mmu.Read(_state.PC.reg++);
-
   switch (opcode)
   {
     case 0x00:
@@ -599,7 +705,7 @@ int Cpu::TickExtended()
     case 0x05:
       return Rlc(_state.HL.low);
     case 0x06:
-      return 8 + Rlc(_mmu.Address(_state.HL.reg));
+      return 8 + ModifyHl([this](std::uint8_t &data) { return Rlc(data); });
     case 0x07:
       return Rlc(_state.AF.high);
     case 0x08:
@@ -615,7 +721,7 @@ int Cpu::TickExtended()
     case 0x0D:
       return Rrc(_state.HL.low);
     case 0x0E:
-      return 8 + Rrc(_mmu.Address(_state.HL.reg));
+      return 8 + ModifyHl([this](std::uint8_t &data) { return Rrc(data); });
     case 0x0F:
       return Rrc(_state.AF.high);
     case 0x10:
@@ -631,7 +737,7 @@ int Cpu::TickExtended()
     case 0x15:
       return Rl(_state.HL.low);
     case 0x16:
-      return 8 + Rl(_mmu.Address(_state.HL.reg));
+      return 8 + ModifyHl([this](std::uint8_t &data) { return Rl(data); });
     case 0x17:
       return Rl(_state.AF.high);
     case 0x18:
@@ -647,7 +753,7 @@ int Cpu::TickExtended()
     case 0x1D:
       return Rr(_state.HL.low);
     case 0x1E:
-      return 8 + Rr(_mmu.Address(_state.HL.reg));
+      return 8 + ModifyHl([this](std::uint8_t &data) { return Rr(data); });
     case 0x1F:
       return Rr(_state.AF.high);
     case 0x20:
@@ -663,7 +769,7 @@ int Cpu::TickExtended()
     case 0x25:
       return Sla(_state.HL.low);
     case 0x26:
-      return 8 + Sla(_mmu.Address(_state.HL.reg));
+      return 8 + ModifyHl([this](std::uint8_t &data) { return Sla(data); });
     case 0x27:
       return Sla(_state.AF.high);
     case 0x28:
@@ -679,7 +785,7 @@ int Cpu::TickExtended()
     case 0x2D:
       return Sra(_state.HL.low);
     case 0x2E:
-      return 8 + Sra(_mmu.Address(_state.HL.reg));
+      return 8 + ModifyHl([this](std::uint8_t &data) { return Sra(data); });
     case 0x2F:
       return Sra(_state.AF.high);
     case 0x30:
@@ -695,7 +801,7 @@ int Cpu::TickExtended()
     case 0x35:
       return Swap(_state.HL.low);
     case 0x36:
-      return 8 + Swap(_mmu.Address(_state.HL.reg));
+      return 8 + ModifyHl([this](std::uint8_t &data) { return Swap(data); });
     case 0x37:
       return Swap(_state.AF.high);
     case 0x38:
@@ -711,7 +817,7 @@ int Cpu::TickExtended()
     case 0x3D:
       return Srl(_state.HL.low);
     case 0x3E:
-      return 8 + Srl(_mmu.Address(_state.HL.reg));
+      return 8 + ModifyHl([this](std::uint8_t &data) { return Srl(data); });
     case 0x3F:
       return Srl(_state.AF.high);
     case 0x40:
@@ -855,7 +961,7 @@ int Cpu::TickExtended()
     case 0x85:
       return Res(_state.HL.low, 0);
     case 0x86:
-      return 8 + Res(_mmu.Address(_state.HL.reg), 0);
+      return 8 + ModifyHl([this](std::uint8_t &data) { return Res(data, 0); });
     case 0x87:
       return Res(_state.AF.high, 0);
     case 0x88:
@@ -871,7 +977,7 @@ int Cpu::TickExtended()
     case 0x8D:
       return Res(_state.HL.low, 1);
     case 0x8E:
-      return 8 + Res(_mmu.Address(_state.HL.reg), 1);
+      return 8 + ModifyHl([this](std::uint8_t &data) { return Res(data, 1); });
     case 0x8F:
       return Res(_state.AF.high, 1);
     case 0x90:
@@ -887,7 +993,7 @@ int Cpu::TickExtended()
     case 0x95:
       return Res(_state.HL.low, 2);
     case 0x96:
-      return 8 + Res(_mmu.Address(_state.HL.reg), 2);
+      return 8 + ModifyHl([this](std::uint8_t &data) { return Res(data, 2); });
     case 0x97:
       return Res(_state.AF.high, 2);
     case 0x98:
@@ -903,7 +1009,7 @@ int Cpu::TickExtended()
     case 0x9D:
       return Res(_state.HL.low, 3);
     case 0x9E:
-      return 8 + Res(_mmu.Address(_state.HL.reg), 3);
+      return 8 + ModifyHl([this](std::uint8_t &data) { return Res(data, 3); });
     case 0x9F:
       return Res(_state.AF.high, 3);
     case 0xA0:
@@ -919,7 +1025,7 @@ int Cpu::TickExtended()
     case 0xA5:
       return Res(_state.HL.low, 4);
     case 0xA6:
-      return 8 + Res(_mmu.Address(_state.HL.reg), 4);
+      return 8 + ModifyHl([this](std::uint8_t &data) { return Res(data, 4); });
     case 0xA7:
       return Res(_state.AF.high, 4);
     case 0xA8:
@@ -935,7 +1041,7 @@ int Cpu::TickExtended()
     case 0xAD:
       return Res(_state.HL.low, 5);
     case 0xAE:
-      return 8 + Res(_mmu.Address(_state.HL.reg), 5);
+      return 8 + ModifyHl([this](std::uint8_t &data) { return Res(data, 5); });
     case 0xAF:
       return Res(_state.AF.high, 5);
     case 0xB0:
@@ -951,7 +1057,7 @@ int Cpu::TickExtended()
     case 0xB5:
       return Res(_state.HL.low, 6);
     case 0xB6:
-      return 8 + Res(_mmu.Address(_state.HL.reg), 6);
+      return 8 + ModifyHl([this](std::uint8_t &data) { return Res(data, 6); });
     case 0xB7:
       return Res(_state.AF.high, 6);
     case 0xB8:
@@ -967,7 +1073,7 @@ int Cpu::TickExtended()
     case 0xBD:
       return Res(_state.HL.low, 7);
     case 0xBE:
-      return 8 + Res(_mmu.Address(_state.HL.reg), 7);
+      return 8 + ModifyHl([this](std::uint8_t &data) { return Res(data, 7); });
     case 0xBF:
       return Res(_state.AF.high, 7);
     case 0xC0:
@@ -983,7 +1089,7 @@ int Cpu::TickExtended()
     case 0xC5:
       return Set(_state.HL.low, 0);
     case 0xC6:
-      return 8 + Set(_mmu.Address(_state.HL.reg), 0);
+      return 8 + ModifyHl([this](std::uint8_t &data) { return Set(data, 0); });
     case 0xC7:
       return Set(_state.AF.high, 0);
     case 0xC8:
@@ -999,7 +1105,7 @@ int Cpu::TickExtended()
     case 0xCD:
       return Set(_state.HL.low, 1);
     case 0xCE:
-      return 8 + Set(_mmu.Address(_state.HL.reg), 1);
+      return 8 + ModifyHl([this](std::uint8_t &data) { return Set(data, 1); });
     case 0xCF:
       return Set(_state.AF.high, 1);
     case 0xD0:
@@ -1015,7 +1121,7 @@ int Cpu::TickExtended()
     case 0xD5:
       return Set(_state.HL.low, 2);
     case 0xD6:
-      return 8 + Set(_mmu.Address(_state.HL.reg), 2);
+      return 8 + ModifyHl([this](std::uint8_t &data) { return Set(data, 2); });
     case 0xD7:
       return Set(_state.AF.high, 2);
     case 0xD8:
@@ -1031,7 +1137,7 @@ int Cpu::TickExtended()
     case 0xDD:
       return Set(_state.HL.low, 3);
     case 0xDE:
-      return 8 + Set(_mmu.Address(_state.HL.reg), 3);
+      return 8 + ModifyHl([this](std::uint8_t &data) { return Set(data, 3); });
     case 0xDF:
       return Set(_state.AF.high, 3);
     case 0xE0:
@@ -1047,7 +1153,7 @@ int Cpu::TickExtended()
     case 0xE5:
       return Set(_state.HL.low, 4);
     case 0xE6:
-      return 8 + Set(_mmu.Address(_state.HL.reg), 4);
+      return 8 + ModifyHl([this](std::uint8_t &data) { return Set(data, 4); });
     case 0xE7:
       return Set(_state.AF.high, 4);
     case 0xE8:
@@ -1063,7 +1169,7 @@ int Cpu::TickExtended()
     case 0xED:
       return Set(_state.HL.low, 5);
     case 0xEE:
-      return 8 + Set(_mmu.Address(_state.HL.reg), 5);
+      return 8 + ModifyHl([this](std::uint8_t &data) { return Set(data, 5); });
     case 0xEF:
       return Set(_state.AF.high, 5);
     case 0xF0:
@@ -1079,7 +1185,7 @@ int Cpu::TickExtended()
     case 0xF5:
       return Set(_state.HL.low, 6);
     case 0xF6:
-      return 8 + Set(_mmu.Address(_state.HL.reg), 6);
+      return 8 + ModifyHl([this](std::uint8_t &data) { return Set(data, 6); });
     case 0xF7:
       return Set(_state.AF.high, 6);
     case 0xF8:
@@ -1095,7 +1201,7 @@ int Cpu::TickExtended()
     case 0xFD:
       return Set(_state.HL.low, 7);
     case 0xFE:
-      return 8 + Set(_mmu.Address(_state.HL.reg), 7);
+      return 8 + ModifyHl([this](std::uint8_t &data) { return Set(data, 7); });
     case 0xFF:
       return Set(_state.AF.high, 7);
     default:
@@ -1106,13 +1212,112 @@ int Cpu::TickExtended()
   return 0x00;
 }
 
+// Opcode dispatch
+//
+// Every opcode gets its own handler, Execute(Opcode) with a constant opcode.
+// With GB_CPU_DISPATCH_COMPUTED_GOTO the handlers are labels inside Dispatch
+// and we jump straight to them, otherwise they are ExecuteOpcode<Opcode>
+// functions called through a table generated at compile time. The engine is
+// picked by the CPU_DISPATCH cmake option.
+
+#if defined(GB_CPU_DISPATCH_COMPUTED_GOTO) \
+    && !(defined(__GNUC__) || defined(__clang__))
+#error "CPU_DISPATCH=COMPUTED_GOTO requires GCC or Clang"
+#endif
+
+// X-macro over all 256 opcodes as two hex digits, e.g X(00) ... X(FF)
+#define GB_OPCODE_ROW(X, h)                                                 \
+  X(h##0) X(h##1) X(h##2) X(h##3) X(h##4) X(h##5) X(h##6) X(h##7) X(h##8) \
+      X(h##9) X(h##A) X(h##B) X(h##C) X(h##D) X(h##E) X(h##F)
+#define GB_OPCODES(X)                                                       \
+  GB_OPCODE_ROW(X, 0) GB_OPCODE_ROW(X, 1) GB_OPCODE_ROW(X, 2)               \
+  GB_OPCODE_ROW(X, 3) GB_OPCODE_ROW(X, 4) GB_OPCODE_ROW(X, 5)               \
+  GB_OPCODE_ROW(X, 6) GB_OPCODE_ROW(X, 7) GB_OPCODE_ROW(X, 8)               \
+  GB_OPCODE_ROW(X, 9) GB_OPCODE_ROW(X, A) GB_OPCODE_ROW(X, B)               \
+  GB_OPCODE_ROW(X, C) GB_OPCODE_ROW(X, D) GB_OPCODE_ROW(X, E)               \
+  GB_OPCODE_ROW(X, F)
+
+template <std::uint8_t Opcode>
+int Cpu::ExecuteOpcode(Cpu &cpu)
+{
+  return cpu.Execute(Opcode);
+}
+
+template <std::uint8_t Opcode>
+int Cpu::ExecuteExtendedOpcode(Cpu &cpu)
+{
+  return cpu.ExecuteExtended(Opcode);
+}
+
+template <std::size_t... Opcodes>
+constexpr Cpu::OpcodeTable Cpu::MakeOpcodeTable(
+    std::index_sequence<Opcodes...> /*unused*/, bool extended)
+{
+  if (extended)
+  {
+    return {&ExecuteExtendedOpcode<static_cast<std::uint8_t>(Opcodes)>...};
+  }
+  return {&ExecuteOpcode<static_cast<std::uint8_t>(Opcodes)>...};
+}
+
+#if defined(GB_CPU_DISPATCH_COMPUTED_GOTO)
+
+#define GB_OPCODE_LABEL_ADDRESS(n) &&op_##n,
+#define GB_OPCODE_LABEL(n) \
+  op_##n:                  \
+  return Execute(0x##n);
+#define GB_EXTENDED_OPCODE_LABEL_ADDRESS(n) &&cb_##n,
+#define GB_EXTENDED_OPCODE_LABEL(n) \
+  cb_##n:                           \
+  return ExecuteExtended(0x##n);
+
+int Cpu::Dispatch(std::uint8_t opcode)
+{
+  static void *const labels[]{GB_OPCODES(GB_OPCODE_LABEL_ADDRESS)};
+  goto *labels[opcode];
+  GB_OPCODES(GB_OPCODE_LABEL)
+}
+
+int Cpu::DispatchExtended(std::uint8_t opcode)
+{
+  static void *const labels[]{GB_OPCODES(GB_EXTENDED_OPCODE_LABEL_ADDRESS)};
+  goto *labels[opcode];
+  GB_OPCODES(GB_EXTENDED_OPCODE_LABEL)
+}
+
+#undef GB_OPCODE_LABEL_ADDRESS
+#undef GB_OPCODE_LABEL
+#undef GB_EXTENDED_OPCODE_LABEL_ADDRESS
+#undef GB_EXTENDED_OPCODE_LABEL
+
+#else
+
+int Cpu::Dispatch(std::uint8_t opcode)
+{
+  static constexpr OpcodeTable table{
+      MakeOpcodeTable(std::make_index_sequence<OPCODE_COUNT>{}, false)};
+  return table[opcode](*this);
+}
+
+int Cpu::DispatchExtended(std::uint8_t opcode)
+{
+  static constexpr OpcodeTable table{
+      MakeOpcodeTable(std::make_index_sequence<OPCODE_COUNT>{}, true)};
+  return table[opcode](*this);
+}
+
+#endif
+
+#undef GB_OPCODES
+#undef GB_OPCODE_ROW
+
 std::uint8_t Cpu::FetchOpcode()
 {
   auto opcode = _mmu.Read(_state.PC.reg);
   // If halt bug occured then don't increment the PC
-  if (_haltBug)
+  if (_state.haltBug)
   {
-    _haltBug = false;
+    _state.haltBug = false;
   }
   else
   {
@@ -1124,42 +1329,42 @@ std::uint8_t Cpu::FetchOpcode()
 void Cpu::HandleInterruptsIfAny()
 {
   // Check if interrupts are enabled
-  if (_state._interrupt->_ime)
+  if (_interrupt->_ime)
   {
     // Check if any interrupts are enabled and requested
-    if ((_state._interrupt->_ie & _state._interrupt->_if) != 0)
+    if ((_interrupt->_ie & _interrupt->_if) != 0)
     {
       // Check if VBlank interrupt is enabled and requested
-      if (BitUtils::Test<InterruptType::VBLANK>(_state._interrupt->_ie)
-          && BitUtils::Test<InterruptType::VBLANK>(_state._interrupt->_if))
+      if (BitUtils::Test<InterruptType::VBLANK>(_interrupt->_ie)
+          && BitUtils::Test<InterruptType::VBLANK>(_interrupt->_if))
       {
         LOG_DEBUG(_logger, "VBlank interrupt is enabled and requested");
         DisableInterruptAndJumpToInterruptHandler(InterruptType::VBLANK);
       }
       // Check if LCD interrupt is enabled and requested
-      else if (BitUtils::Test<InterruptType::LCD>(_state._interrupt->_ie)
-               && BitUtils::Test<InterruptType::LCD>(_state._interrupt->_if))
+      else if (BitUtils::Test<InterruptType::LCD>(_interrupt->_ie)
+               && BitUtils::Test<InterruptType::LCD>(_interrupt->_if))
       {
         LOG_DEBUG(_logger, "LCD interrupt is enabled and requested");
         DisableInterruptAndJumpToInterruptHandler(InterruptType::LCD);
       }
       // Check if Timer interrupt is enabled and requested
-      else if (BitUtils::Test<InterruptType::TIMER>(_state._interrupt->_ie)
-               && BitUtils::Test<InterruptType::TIMER>(_state._interrupt->_if))
+      else if (BitUtils::Test<InterruptType::TIMER>(_interrupt->_ie)
+               && BitUtils::Test<InterruptType::TIMER>(_interrupt->_if))
       {
         LOG_DEBUG(_logger, "Timer interrupt is enabled and requested");
         DisableInterruptAndJumpToInterruptHandler(InterruptType::TIMER);
       }
       // Check if Serial interrupt is enabled and requested
-      else if (BitUtils::Test<InterruptType::SERIAL>(_state._interrupt->_ie)
-               && BitUtils::Test<InterruptType::SERIAL>(_state._interrupt->_if))
+      else if (BitUtils::Test<InterruptType::SERIAL>(_interrupt->_ie)
+               && BitUtils::Test<InterruptType::SERIAL>(_interrupt->_if))
       {
         LOG_DEBUG(_logger, "Serial interrupt is enabled and requested");
         DisableInterruptAndJumpToInterruptHandler(InterruptType::SERIAL);
       }
       // Check if Joypad interrupt is enabled and requested
-      else if (BitUtils::Test<InterruptType::JOYPAD>(_state._interrupt->_ie)
-               && BitUtils::Test<InterruptType::JOYPAD>(_state._interrupt->_if))
+      else if (BitUtils::Test<InterruptType::JOYPAD>(_interrupt->_ie)
+               && BitUtils::Test<InterruptType::JOYPAD>(_interrupt->_if))
       {
         LOG_DEBUG(_logger, "Joypad interrupt is enabled and requested");
         DisableInterruptAndJumpToInterruptHandler(InterruptType::JOYPAD);
@@ -1184,41 +1389,54 @@ void Cpu::DisableInterruptAndJumpToInterruptHandler(InterruptType interruptType)
     case InterruptType::VBLANK:
       LOG_DEBUG(_logger,
           "Unset bit VBLANK (0) in Interrupt Flag register (IF: 0xFF0F)");
-      BitUtils::Unset<InterruptType::VBLANK>(_state._interrupt->_if);
+      BitUtils::Unset<InterruptType::VBLANK>(_interrupt->_if);
       LOG_DEBUG(_logger, "Jumping to VBLANK interrupt handler");
       _state.PC.reg = VBLANK_INTERRUPT_HANDLER_ADDRESS;
       break;
     case InterruptType::LCD:
       LOG_DEBUG(
           _logger, "Unset bit LCD (1) in Interrupt Flag register (IF: 0xFF0F)");
-      BitUtils::Unset<InterruptType::LCD>(_state._interrupt->_if);
+      BitUtils::Unset<InterruptType::LCD>(_interrupt->_if);
       LOG_DEBUG(_logger, "Jumping to LCD interrupt handler");
       _state.PC.reg = STAT_INTERRUPT_HANDLER_ADDRESS;
       break;
     case InterruptType::TIMER:
       LOG_DEBUG(_logger,
           "Unset bit TIMER (2) in Interrupt Flag register (IF: 0xFF0F)");
-      BitUtils::Unset<InterruptType::TIMER>(_state._interrupt->_if);
+      BitUtils::Unset<InterruptType::TIMER>(_interrupt->_if);
       LOG_DEBUG(_logger, "Jumping to TIMER interrupt handler");
       _state.PC.reg = TIMER_INTERRUPT_HANDLER_ADDRESS;
       break;
     case InterruptType::SERIAL:
       LOG_DEBUG(_logger,
           "Unset bit SERIAL (3) in Interrupt Flag register (IF: 0xFF0F)");
-      BitUtils::Unset<InterruptType::SERIAL>(_state._interrupt->_if);
+      BitUtils::Unset<InterruptType::SERIAL>(_interrupt->_if);
       LOG_DEBUG(_logger, "Jumping to SERIAL interrupt handler");
       _state.PC.reg = SERIAL_INTERRUPT_HANDLER_ADDRESS;
       break;
     case InterruptType::JOYPAD:
       LOG_DEBUG(_logger,
           "Unset bit JOYPAD (4) in Interrupt Flag register (IF: 0xFF0F)");
-      BitUtils::Unset<InterruptType::JOYPAD>(_state._interrupt->_if);
+      BitUtils::Unset<InterruptType::JOYPAD>(_interrupt->_if);
       LOG_DEBUG(_logger, "Jumping to JOYPAD interrupt handler");
       _state.PC.reg = JOYPAD_INTERRUPT_HANDLER_ADDRESS;
       break;
   }
 }
 
+// Record an 8 bit alu operation in place of its flags, Flags() works them out
+// when something reads them. Inc and Dec keep the carry flag, so it's saved
+GB_ALWAYS_INLINE void Cpu::DeferFlags(
+    FlagOp op, std::uint8_t a, std::uint8_t b, std::uint16_t res)
+{
+  std::uint8_t carry{};
+  if (op == FlagOp::Inc || op == FlagOp::Dec)
+  {
+    carry = static_cast<std::uint8_t>(GetCY() ? 0x10U : 0U);
+  }
+  _deferredFlags = {.op = op, .a = a, .b = b, .carry = carry, .res = res};
+}
+
 // opcodes
 
 int Cpu::DecHl()
@@ -1226,9 +1444,7 @@ int Cpu::DecHl()
   uint8_t data = _mmu.Read(_state.HL.reg);
   uint16_t res = data - 1;
 
-  SetZ((res & 0xFFU) == 0);
-  SetN(true);
-  SetH(((data & 0x0FU) - 1U) > 0x0F);
+  DeferFlags(FlagOp::Dec, data, 1, res);
 
   _mmu.Write(_state.HL.reg, (res & 0xFFU));
   return 12;
@@ -1267,10 +1483,7 @@ int Cpu::OrU8()
   uint16_t res =
       static_cast<uint16_t>(_state.AF.high) | static_cast<uint16_t>(u8);
 
-  SetZ((res & 0xFFU) == 0);
-  SetN(false);
-  SetH(false);
-  SetCY(false);
+  DeferFlags(FlagOp::Or, _state.AF.high, 0, res);
 
   _state.AF.high = (res & 0xFFU);
   return 8;
@@ -1286,10 +1499,7 @@ int Cpu::AndU8()
 {
   uint8_t u8 = _mmu.Read(_state.PC.reg++);
   uint8_t res = _state.AF.high & u8;
-  SetZ(res == 0);
-  SetN(false);
-  SetH(true);
-  SetCY(false);
+  DeferFlags(FlagOp::And, _state.AF.high, 0, res);
 
   _state.AF.high = res;
   return 8;
@@ -1319,10 +1529,7 @@ int Cpu::XorU8()
 {
   uint8_t u8 = _mmu.Read(_state.PC.reg++);
   uint8_t res = _state.AF.high ^ u8;
-  SetZ(res == 0);
-  SetN(false);
-  SetH(false);
-  SetCY(false);
+  DeferFlags(FlagOp::Or, _state.AF.high, 0, res);
 
   _state.AF.high = res;
   return 8;
@@ -1333,7 +1540,7 @@ int Cpu::RetI()
   uint8_t lsb = _mmu.Read(_state.SP.reg++);
   uint8_t msb = _mmu.Read(_state.SP.reg++);
   _state.PC.reg = ToU16(lsb, msb);
-  _state._interrupt->_ime = true;
+  _interrupt->_ime = true;
   return 16;
 }
 
@@ -1343,10 +1550,7 @@ int Cpu::SubU8()
   uint16_t res =
       static_cast<uint16_t>(_state.AF.high) - static_cast<uint16_t>(u8);
 
-  SetZ((res & 0xFFU) == 0);
-  SetN(true);
-  SetH(((_state.AF.high & 0xFU) - (u8 & 0xFU)) > 0xFU);
-  SetCY(res > 0xFFU);
+  DeferFlags(FlagOp::Sub, _state.AF.high, u8, res);
 
   _state.AF.high = (res & 0xFFU);
   return 8;
@@ -1354,15 +1558,12 @@ int Cpu::SubU8()
 
 int Cpu::SbcU8()
 {
-  auto c = static_cast<uint16_t>((_state.AF.low & (1U << 4U)) >> 4U);
+  auto c = static_cast<uint16_t>(GetCY());
   uint8_t u8 = _mmu.Read(_state.PC.reg++);
   uint16_t res =
       static_cast<uint16_t>(_state.AF.high) - static_cast<uint16_t>(u8) - c;
 
-  SetZ((res & 0xFFU) == 0);
-  SetN(true);
-  SetH(((_state.AF.high & 0xFU) - (u8 & 0xFU) - c) > 0xFU);
-  SetCY(res > 0xFFU);
+  DeferFlags(FlagOp::Sub, _state.AF.high, u8, res);
 
   _state.AF.high = (res & 0xFFU);
   return 8;
@@ -1377,15 +1578,12 @@ int Cpu::AddU8()
 
 int Cpu::AdcU8()
 {
-  auto c = static_cast<uint16_t>((_state.AF.low & (1U << 4U)) >> 4U);
+  auto c = static_cast<uint16_t>(GetCY());
   uint8_t u8 = _mmu.Read(_state.PC.reg++);
   uint16_t res =
       static_cast<uint16_t>(_state.AF.high) + static_cast<uint16_t>(u8) + c;
 
-  SetZ((res & 0xFFU) == 0);
-  SetN(false);
-  SetH(((_state.AF.high & 0xFU) + (u8 & 0xFU) + c) > 0xFU);
-  SetCY(res > 0xFFU);
+  DeferFlags(FlagOp::Add, _state.AF.high, u8, res);
 
   _state.AF.high = (res & 0xFFU);
   return 8;
@@ -1396,10 +1594,7 @@ int Cpu::AndR(std::uint8_t reg)
   uint16_t res =
       static_cast<uint16_t>(_state.AF.high) & static_cast<uint16_t>(reg);
 
-  SetZ((res & 0xFFU) == 0);
-  SetN(false);
-  SetH(true);
-  SetCY(false);
+  DeferFlags(FlagOp::And, _state.AF.high, 0, res);
 
   _state.AF.high = (res & 0xFFU);
   return 4;
@@ -1411,10 +1606,7 @@ int Cpu::AndIHl()
   uint16_t res =
       static_cast<uint16_t>(_state.AF.high) & static_cast<uint16_t>(u8);
 
-  SetZ((res & 0xFFU) == 0);
-  SetN(false);
-  SetH(true);
-  SetCY(false);
+  DeferFlags(FlagOp::And, _state.AF.high, 0, res);
 
   _state.AF.high = (res & 0xFFU);
   return 8;
@@ -1425,10 +1617,7 @@ int Cpu::XorR(std::uint8_t reg)
   uint16_t res =
       static_cast<uint16_t>(_state.AF.high) ^ static_cast<uint16_t>(reg);
 
-  SetZ((res & 0xFFU) == 0);
-  SetN(false);
-  SetH(false);
-  SetCY(false);
+  DeferFlags(FlagOp::Or, _state.AF.high, 0, res);
 
   _state.AF.high = (res & 0xFFU);
   return 4;
@@ -1440,10 +1629,7 @@ int Cpu::XorIHl()
   uint16_t res =
       static_cast<uint16_t>(_state.AF.high) ^ static_cast<uint16_t>(u8);
 
-  SetZ((res & 0xFFU) == 0);
-  SetN(false);
-  SetH(false);
-  SetCY(false);
+  DeferFlags(FlagOp::Or, _state.AF.high, 0, res);
 
   _state.AF.high = (res & 0xFFU);
   return 8;
@@ -1454,10 +1640,7 @@ int Cpu::OrR(std::uint8_t reg)
   uint16_t res =
       static_cast<uint16_t>(_state.AF.high) | static_cast<uint16_t>(reg);
 
-  SetZ((res & 0xFFU) == 0);
-  SetN(false);
-  SetH(false);
-  SetCY(false);
+  DeferFlags(FlagOp::Or, _state.AF.high, 0, res);
 
   _state.AF.high = (res & 0xFFU);
   return 4;
@@ -1469,10 +1652,7 @@ int Cpu::OrIHl()
   uint16_t res =
       static_cast<uint16_t>(_state.AF.high) | static_cast<uint16_t>(u8);
 
-  SetZ((res & 0xFFU) == 0);
-  SetN(false);
-  SetH(false);
-  SetCY(false);
+  DeferFlags(FlagOp::Or, _state.AF.high, 0, res);
 
   _state.AF.high = (res & 0xFFU);
   return 8;
@@ -1483,10 +1663,7 @@ int Cpu::CpR(std::uint8_t reg)
   uint16_t res =
       static_cast<uint16_t>(_state.AF.high) - static_cast<uint16_t>(reg);
 
-  SetZ((res & 0xFFU) == 0);
-  SetN(true);
-  SetH(((_state.AF.high & 0xFU) - (reg & 0xFU)) > 0xFU);
-  SetCY(res > 0xFFU);
+  DeferFlags(FlagOp::Sub, _state.AF.high, reg, res);
   return 4;
 }
 
@@ -1496,10 +1673,7 @@ int Cpu::CpIHl()
   uint16_t res =
       static_cast<uint16_t>(_state.AF.high) - static_cast<uint16_t>(u8);
 
-  SetZ((res & 0xFFU) == 0);
-  SetN(true);
-  SetH(((_state.AF.high & 0xFU) - (u8 & 0xFU)) > 0xFU);
-  SetCY(res > 0xFFU);
+  DeferFlags(FlagOp::Sub, _state.AF.high, u8, res);
   return 8;
 }
 
@@ -1509,10 +1683,7 @@ int Cpu::SubIHl()
   uint16_t res =
       static_cast<uint16_t>(_state.AF.high) - static_cast<uint16_t>(u8);
 
-  SetZ((res & 0xFFU) == 0);
-  SetN(true);
-  SetH(((_state.AF.high & 0xFU) - (u8 & 0xFU)) > 0xFU);
-  SetCY(res > 0xFFU);
+  DeferFlags(FlagOp::Sub, _state.AF.high, u8, res);
 
   _state.AF.high = (res & 0xFFU);
   return 8;
@@ -1520,15 +1691,12 @@ int Cpu::SubIHl()
 
 int Cpu::SbcIHl()
 {
-  auto c = static_cast<uint16_t>((_state.AF.low & (1U << 4U)) >> 4U);
+  auto c = static_cast<uint16_t>(GetCY());
   uint8_t u8 = _mmu.Read(_state.HL.reg);
   uint16_t res =
       static_cast<uint16_t>(_state.AF.high) - static_cast<uint16_t>(u8) - c;
 
-  SetZ((res & 0xFFU) == 0);
-  SetN(true);
-  SetH(((_state.AF.high & 0xFU) - (u8 & 0xFU) - c) > 0xFU);
-  SetCY(res > 0xFFU);
+  DeferFlags(FlagOp::Sub, _state.AF.high, u8, res);
 
   _state.AF.high = (res & 0xFFU);
   return 8;
@@ -1536,14 +1704,11 @@ int Cpu::SbcIHl()
 
 int Cpu::SbcR(std::uint8_t reg)
 {
-  auto c = static_cast<uint16_t>((_state.AF.low & (1U << 4U)) >> 4U);
+  auto c = static_cast<uint16_t>(GetCY());
   uint16_t res =
       static_cast<uint16_t>(_state.AF.high) - static_cast<uint16_t>(reg) - c;
 
-  SetZ((res & 0xFFU) == 0);
-  SetN(true);
-  SetH(((_state.AF.high & 0xFU) - (reg & 0xFU) - c) > 0xFU);
-  SetCY(res > 0xFFU);
+  DeferFlags(FlagOp::Sub, _state.AF.high, reg, res);
 
   _state.AF.high = (res & 0xFFU);
   return 4;
@@ -1551,15 +1716,12 @@ int Cpu::SbcR(std::uint8_t reg)
 
 int Cpu::AdcIHl()
 {
-  auto c = static_cast<uint16_t>((_state.AF.low & (1U << 4U)) >> 4U);
+  auto c = static_cast<uint16_t>(GetCY());
   uint8_t u8 = _mmu.Read(_state.HL.reg);
   uint16_t res =
       static_cast<uint16_t>(_state.AF.high) + static_cast<uint16_t>(u8) + c;
 
-  SetZ((res & 0xFFU) == 0);
-  SetN(false);
-  SetH(((_state.AF.high & 0xFU) + (u8 & 0xFU) + c) > 0xFU);
-  SetCY(res > 0xFFU);
+  DeferFlags(FlagOp::Add, _state.AF.high, u8, res);
 
   _state.AF.high = (res & 0xFFU);
   return 8;
@@ -1570,10 +1732,7 @@ int Cpu::AddR(std::uint8_t reg)
   uint16_t res =
       static_cast<uint16_t>(_state.AF.high) + static_cast<uint16_t>(reg);
 
-  SetZ((res & 0xFFU) == 0);
-  SetN(false);
-  SetH(((_state.AF.high ^ reg ^ res) & 0x10) != 0);
-  SetCY(((_state.AF.high ^ reg ^ res) & 0x100) != 0);
+  DeferFlags(FlagOp::Add, _state.AF.high, reg, res);
 
   _state.AF.high = (res & 0xFFU);
   return 4;
@@ -1581,14 +1740,11 @@ int Cpu::AddR(std::uint8_t reg)
 
 int Cpu::AdcR(std::uint8_t reg)
 {
-  auto c = static_cast<uint16_t>((_state.AF.low & (1U << 4U)) >> 4U);
+  auto c = static_cast<uint16_t>(GetCY());
   uint16_t res =
       static_cast<uint16_t>(_state.AF.high) + static_cast<uint16_t>(reg) + c;
 
-  SetZ((res & 0xFFU) == 0);
-  SetN(false);
-  SetH(((_state.AF.high & 0xFU) + (reg & 0xFU) + c) > 0xFU);
-  SetCY(res > 0xFFU);
+  DeferFlags(FlagOp::Add, _state.AF.high, reg, res);
 
   _state.AF.high = (res & 0xFFU);
   return 4;
@@ -1596,20 +1752,20 @@ int Cpu::AdcR(std::uint8_t reg)
 
 int Cpu::Halt()
 {
-  auto &interrupt = _state._interrupt;
+  auto &interrupt = _interrupt;
   if (interrupt->_ime)
   {
-    _halted = true;
+    _state.halted = true;
   }
   else
   {
     if ((interrupt->_ie & interrupt->_if & 0x1F) == 0x00)
     {
-      _halted = true;
+      _state.halted = true;
     }
     else
     {
-      _haltBug = true;
+      _state.haltBug = true;
     }
   }
   return 4;
@@ -1617,6 +1773,7 @@ int Cpu::Halt()
 
 int Cpu::Ccf()
 {
+  MaterializeFlags();
   SetN(false);
   SetH(false);
 
@@ -1644,9 +1801,7 @@ int Cpu::IncIHl()
   uint8_t data = _mmu.Read(_state.HL.reg);
   uint16_t res = data + 1;
 
-  SetZ((res & 0xFFU) == 0);
-  SetN(false);
-  SetH(((data & 0x0FU) + 1U) > 0x0F);
+  DeferFlags(FlagOp::Inc, data, 1, res);
 
   _mmu.Write(_state.HL.reg, (res & 0xFFU));
   return 12;
@@ -1665,6 +1820,7 @@ int Cpu::Cpl()
 // (https://forums.nesdev.org/viewtopic.php?p=196282&sid=a1cdd6adc0b01ea3d77f61aee9527449#p196282)
 int Cpu::Daa()
 {
+  MaterializeFlags();
   if (!(_state.AF.low & (1U << 6U)))
   {
     if ((_state.AF.low & (1U << 4U)) || _state.AF.high > 0x99)
@@ -1697,7 +1853,7 @@ int Cpu::Daa()
 
 int Cpu::Rra()
 {
-  uint8_t oldCY = (_state.AF.low & (1U << 4U)) >> 4U;
+  uint8_t oldCY = GetCY() ? 1U : 0U;
 
   SetZ(false);
   SetN(false);
@@ -1793,7 +1949,7 @@ int Cpu::LdRIHl(std::uint8_t &reg)
 
 int Cpu::Ei()
 {
-  _state._interrupt->_enableRequested = true;
+  _interrupt->_enableRequested = true;
   LOG_DEBUG(_logger, "Enable interrupt requested");
   return 4;
 }
@@ -1820,8 +1976,8 @@ int Cpu::LdHlU8()
 
 int Cpu::Di()
 {
-  _state._interrupt->_enableRequested = false;
-  _state._interrupt->_ime = false;
+  _interrupt->_enableRequested = false;
+  _interrupt->_ime = false;
   LOG_DEBUG(_logger, "Interrupt disabled");
   return 4;
 }
@@ -1851,10 +2007,7 @@ int Cpu::SubR(std::uint8_t reg)
   uint16_t res =
       static_cast<uint16_t>(_state.AF.high) - static_cast<uint16_t>(reg);
 
-  SetZ((res & 0xFFU) == 0);
-  SetN(true);
-  SetH(((_state.AF.high & 0xFU) - (reg & 0xFU)) > 0xFU);
-  SetCY(res > 0xFFU);
+  DeferFlags(FlagOp::Sub, _state.AF.high, reg, res);
 
   _state.AF.high = (res & 0xFFU);
   return 4;
@@ -1866,10 +2019,7 @@ int Cpu::AddAHl()
   uint16_t res =
       static_cast<uint16_t>(_state.AF.high) + static_cast<uint16_t>(data);
 
-  SetZ((res & 0xFFU) == 0);
-  SetN(false);
-  SetH(((_state.AF.high ^ data ^ res) & 0x10) != 0);
-  SetCY(((_state.AF.high ^ data ^ res) & 0x100) != 0);
+  DeferFlags(FlagOp::Add, _state.AF.high, data, res);
 
   _state.AF.high = (res & 0xFFU);
   return 8;
@@ -1888,10 +2038,7 @@ int Cpu::CpU8()
   uint16_t res =
       static_cast<uint16_t>(_state.AF.high) - static_cast<uint16_t>(u8);
 
-  SetZ((res & 0xFFU) == 0);
-  SetN(true);
-  SetH(((_state.AF.high & 0xFU) - (u8 & 0xFU)) > 0xFU);
-  SetCY(res > 0xFFU);
+  DeferFlags(FlagOp::Sub, _state.AF.high, u8, res);
   return 8;
 }
 
@@ -1901,10 +2048,7 @@ int Cpu::CpAHl()
   uint16_t res =
       static_cast<uint16_t>(_state.AF.high) - static_cast<uint16_t>(u8);
 
-  SetZ((res & 0xFFU) == 0);
-  SetN(true);
-  SetH(((_state.AF.high & 0xFU) - (u8 & 0xFU)) > 0xFU);
-  SetCY(res > 0xFFU);
+  DeferFlags(FlagOp::Sub, _state.AF.high, u8, res);
   return 0x00;
 }
 
@@ -1919,9 +2063,7 @@ int Cpu::DecR(std::uint8_t &reg)
 {
   std::uint8_t res = reg - 1;
 
-  SetZ(res == 0);
-  SetN(true);
-  SetH(((reg & 0xFU) - 1) > 0xFU);
+  DeferFlags(FlagOp::Dec, reg, 1, res);
 
   reg = res;
   return 4;
@@ -1938,7 +2080,7 @@ int Cpu::PopRr(Register &reg)
 
 int Cpu::RlA()
 {
-  uint8_t oldCY = (_state.AF.low & (1U << 4U)) >> 4U;
+  uint8_t oldCY = GetCY() ? 1U : 0U;
 
   SetZ(false);
   SetN(false);
@@ -2041,6 +2183,11 @@ int Cpu::JrCCI8(bool cc)
   auto i8 = static_cast<std::int8_t>(_mmu.Read(_state.PC.reg++));
   if (cc)
   {
+    if (i8 < 0)
+    {
+      _backwardJump = true;
+      _backwardJumpEnd = _state.PC.reg;
+    }
     _state.PC.reg = static_cast<std::uint16_t>(_state.PC.reg + i8);
     return 12;
   }
@@ -2076,9 +2223,7 @@ int Cpu::IncR(std::uint8_t &reg)
 {
   uint16_t res = reg + 1;
 
-  SetZ((res & 0xFFU) == 0);
-  SetN(false);
-  SetH(((reg & 0x0FU) + 1) > 0x0FU);
+  DeferFlags(FlagOp::Inc, reg, 1, res);
 
   reg = (res & 0xFFU);
   return 4;
@@ -2093,7 +2238,7 @@ int Cpu::IncRr(Register &reg)
 // extended opcodes
 int Cpu::RlR(std::uint8_t &reg)
 {
-  uint8_t oldCY = (_state.AF.low & (1U << 4U)) >> 4U;
+  uint8_t oldCY = GetCY() ? 1U : 0U;
   uint8_t bit7 = (reg & (1U << 7U)) >> 7U;
   reg = static_cast<uint8_t>(reg << 1U);
   reg = (reg & static_cast<std::uint8_t>(~(1U << 0U))) | oldCY;
@@ -2144,7 +2289,7 @@ int Cpu::Rrc(uint8_t &reg)
 
 int Cpu::Rl(uint8_t &reg)
 {
-  uint8_t oldCY = (_state.AF.low & (1U << 4U)) >> 4U;
+  uint8_t oldCY = GetCY() ? 1U : 0U;
   uint8_t bit7 = (reg & 0x80U) >> 7U;
   reg = static_cast<std::uint8_t>(reg << 1U);
   reg = (reg & ~(1U << 0U)) | (oldCY);
@@ -2158,7 +2303,7 @@ int Cpu::Rl(uint8_t &reg)
 
 int Cpu::Rr(uint8_t &reg)
 {
-  uint8_t oldCY = (_state.AF.low & (1U << 4U)) >> 4U;
+  uint8_t oldCY = GetCY() ? 1U : 0U;
   uint8_t bit0 = (reg & 0x01U);
   reg = reg >> 1U;
   reg = (reg & static_cast<std::uint8_t>(~(1U << 7U)))
@@ -2226,8 +2371,7 @@ int Cpu::Swap(uint8_t &reg)
 int Cpu::Bit(uint8_t reg, uint8_t bit)
 {
   uint8_t bitX = (reg & (1U << bit)) >> bit;
-  _state.AF.low = (_state.AF.low & static_cast<std::uint8_t>(~(1U << 7U)))
-                  | static_cast<std::uint8_t>(((!bitX) << 7U));
+  SetZ(bitX == 0);
   SetN(false);
   SetH(true);
   return 8;
@@ -2251,6 +2395,7 @@ int Cpu::Set(uint8_t &reg, uint8_t bit)
 // Set zero flag
 void Cpu::SetZ(bool value)
 {
+  MaterializeFlags();
   _state.AF.low = (_state.AF.low & static_cast<std::uint8_t>(~(1U << 7U)))
                   | static_cast<uint8_t>(value << 7U);
 }
@@ -2259,12 +2404,13 @@ void Cpu::SetZ(bool value)
 [[nodiscard]]
 bool Cpu::GetZ() const
 {
-  return ((_state.AF.low & (1U << 7U)) >> 7U) == 1;
+  return ((Flags() & (1U << 7U)) >> 7U) == 1;
 }
 
 // Set negative flag
 void Cpu::SetN(bool value)
 {
+  MaterializeFlags();
   _state.AF.low = (_state.AF.low & static_cast<std::uint8_t>(~(1U << 6U)))
                   | static_cast<uint8_t>(value << 6U);
 }
@@ -2273,12 +2419,13 @@ void Cpu::SetN(bool value)
 [[nodiscard]]
 bool Cpu::GetN() const
 {
-  return ((_state.AF.low & (1U << 6U)) >> 6U) == 1;
+  return ((Flags() & (1U << 6U)) >> 6U) == 1;
 }
 
 // Set half carry flag
 void Cpu::SetH(bool value)
 {
+  MaterializeFlags();
   _state.AF.low = (_state.AF.low & static_cast<std::uint8_t>(~(1U << 5U)))
                   | static_cast<uint8_t>(value << 5U);
 }
@@ -2287,12 +2434,13 @@ void Cpu::SetH(bool value)
 [[nodiscard]]
 bool Cpu::GetH() const
 {
-  return ((_state.AF.low & (1U << 5U)) >> 5U) == 1;
+  return ((Flags() & (1U << 5U)) >> 5U) == 1;
 }
 
 // Set carry flag
 void Cpu::SetCY(bool value)
 {
+  MaterializeFlags();
   _state.AF.low = (_state.AF.low & static_cast<std::uint8_t>(~(1U << 4U)))
                   | static_cast<uint8_t>(value << 4U);
 }
@@ -2301,7 +2449,46 @@ void Cpu::SetCY(bool value)
 [[nodiscard]]
 bool Cpu::GetCY() const
 {
-  return ((_state.AF.low & (1U << 4U)) >> 4U) == 1;
+  return ((Flags() & (1U << 4U)) >> 4U) == 1;
+}
+
+// Flags register with the deferred flags applied
+[[nodiscard]]
+std::uint8_t Cpu::Flags() const
+{
+  const auto &deferred = _deferredFlags;
+  // every deferred operation sets Z from its result
+  unsigned int zero = (deferred.res & 0xFFU) == 0 ? 0x80U : 0U;
+  // bit 4 of a ^ b ^ res is the carry (or borrow) into bit 4
+  unsigned int halfCarry =
+      ((deferred.a ^ deferred.b ^ deferred.res) & 0x10U) << 1U;
+  // bit 8 of res is the carry (or borrow) out of bit 7
+  unsigned int carry = (deferred.res & 0x100U) >> 4U;
+  switch (deferred.op)
+  {
+    case FlagOp::None:
+      return _state.AF.low;
+    case FlagOp::Add:
+      return static_cast<std::uint8_t>(zero | halfCarry | carry);
+    case FlagOp::Sub:
+      return static_cast<std::uint8_t>(zero | 0x40U | halfCarry | carry);
+    case FlagOp::Inc:
+      return static_cast<std::uint8_t>(zero | halfCarry | deferred.carry);
+    case FlagOp::Dec:
+      return static_cast<std::uint8_t>(
+          zero | 0x40U | halfCarry | deferred.carry);
+    case FlagOp::And:
+      return static_cast<std::uint8_t>(zero | 0x20U);
+    case FlagOp::Or:
+      return static_cast<std::uint8_t>(zero);
+  }
+  return _state.AF.low;
+}
+
+void Cpu::MaterializeFlags()
+{
+  _state.AF.low = Flags();
+  _deferredFlags.op = FlagOp::None;
 }
 
 std::uint16_t Cpu::ToU16(std::uint8_t lsb, std::uint8_t msb)
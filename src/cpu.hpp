@@ -2,11 +2,16 @@
 
 #include <spdlog/logger.h>
 
+#include <array>
+#include <cstddef>
 #include <memory>
+#include <utility>
 
 #include "interrupt.hpp"
 #include "mmu.hpp"
 #include "register.hpp"
+#include "savestate.hpp"
+#include "scheduler.hpp"
 
 struct CpuState
 {
@@ -16,24 +21,96 @@ struct CpuState
   Register HL{};
   Register SP{};
   Register PC{};
-  std::shared_ptr<Interrupt> _interrupt;
+  bool halted{};
+  bool haltBug{};
 };
 
 class Cpu
 {
 public:
+  // cycles a Tick takes while the cpu is halted
+  constexpr static int HALTED_TICK_CYCLES{4};
+
   explicit Cpu(MemoryManagementUnit &mmu);
   Cpu(CpuState state, MemoryManagementUnit &mmu);
 
   [[nodiscard]]
   CpuState GetCpuState() const;
 
+  void SaveState(SaveStateWriter &writer) const;
+  void LoadState(SaveStateReader &reader);
+
   int Tick();
 
+  // Run instructions like Tick, advancing the scheduler after each of them,
+  // but do the halt and interrupt checks only before the first one. It stops
+  // when an event is due, after a taken backward relative jump and after any
+  // instruction that may wake the cpu up, make it take an interrupt or halt
+  // it: memory writes, DI, EI, RETI, HALT and STOP. Opcodes are still fetched
+  // and decoded one at a time, nothing is cached.
+  void RunUntilInterruptCheck(Scheduler &scheduler);
+
+  // true while the cpu is halted and no interrupt is pending, it does nothing
+  // but take HALTED_TICK_CYCLES per Tick until an interrupt is requested
+  [[nodiscard]]
+  bool IsWaitingForInterrupt() const
+  {
+    return _state.halted && (_interrupt->_ie & _interrupt->_if & 0x1F) == 0;
+  }
+
+  // true once after each taken backward relative jump, the start of another
+  // iteration of a loop that ends at BackwardJumpEnd()
+  [[nodiscard]]
+  bool TakeBackwardJump()
+  {
+    auto jumped = _backwardJump;
+    _backwardJump = false;
+    return jumped;
+  }
+
+  // address after the last backward relative jump taken
+  [[nodiscard]]
+  std::uint16_t BackwardJumpEnd() const
+  {
+    return _backwardJumpEnd;
+  }
+
 private:
+  constexpr static std::size_t OPCODE_COUNT{256};
+  using OpcodeHandler = int (*)(Cpu &cpu);
+  using OpcodeTable = std::array<OpcodeHandler, OPCODE_COUNT>;
+
   int TickExtended();
 
+  // opcode dispatch, the engine is selected at build time (see cpu.cpp)
+  int Dispatch(std::uint8_t opcode);
+  int DispatchExtended(std::uint8_t opcode);
+  int Execute(std::uint8_t opcode);
+  int ExecuteExtended(std::uint8_t opcode);
+
+  template <std::uint8_t Opcode>
+  static int ExecuteOpcode(Cpu &cpu);
+
+  template <std::uint8_t Opcode>
+  static int ExecuteExtendedOpcode(Cpu &cpu);
+
+  template <std::size_t... Opcodes>
+  static constexpr OpcodeTable MakeOpcodeTable(
+      std::index_sequence<Opcodes...> opcodes, bool extended);
+
+  void TraceState() const;
+  // wake up and take interrupts before an instruction, false if the cpu stays
+  // halted and no instruction is run
+  bool StartInstruction();
+  // true if the halt and interrupt checks have to run again after the
+  // instruction that just ran (see RunUntilInterruptCheck)
+  [[nodiscard]]
+  bool NeedsInterruptCheck(std::uint8_t opcode) const;
   std::uint8_t FetchOpcode();
+  // Run a register operation on the byte at (HL), it's read and written back
+  // through the mmu so the memory range holding it sees the write
+  template <typename Operation>
+  int ModifyHl(Operation operation);
   void HandleInterruptsIfAny();
   void DisableInterruptAndJumpToInterruptHandler(InterruptType interruptType);
 
@@ -161,12 +238,45 @@ private:
   [[nodiscard]]
   bool GetCY() const;
 
+  // Flags register with the deferred flags applied
+  [[nodiscard]]
+  std::uint8_t Flags() const;
+  // Write the deferred flags to AF
+  void MaterializeFlags();
+
   static std::uint16_t ToU16(std::uint8_t lsb, std::uint8_t msb);
 
 private:
+  // 8 bit alu operations whose flags are worked out only when read
+  enum class FlagOp : std::uint8_t
+  {
+    None,
+    Add,
+    Sub,
+    Inc,
+    Dec,
+    And,
+    Or
+  };
+
+  // Last 8 bit alu operation, the flags in AF are stale while op isn't None
+  struct DeferredFlags
+  {
+    FlagOp op{FlagOp::None};
+    std::uint8_t a{};
+    std::uint8_t b{};
+    // carry flag kept by Inc and Dec
+    std::uint8_t carry{};
+    std::uint16_t res{};
+  };
+
+  void DeferFlags(FlagOp op, std::uint8_t a, std::uint8_t b, std::uint16_t res);
+
   CpuState _state;
+  DeferredFlags _deferredFlags{};
+  bool _backwardJump{};
+  std::uint16_t _backwardJumpEnd{};
+  std::shared_ptr<Interrupt> _interrupt;
   MemoryManagementUnit &_mmu;
   std::shared_ptr<spdlog::logger> _logger{};
-  bool _halted{};
-  bool _haltBug{};
 };
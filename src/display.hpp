@@ -1,6 +1,9 @@
 #pragma once
 
-#include "pixel.hpp"
+#include <cstdint>
+#include <span>
+
+#include "common.hpp"
 
 struct Display
 {
@@ -11,6 +14,10 @@ struct Display
   virtual ~Display() = default;
   Display() = default;
 
-  virtual void Draw(const Pixel &) = 0;
+  // Draw a whole line of the lcd. Pixels are dmg shades after the palette is
+  // applied, 0 (lightest) to 3 (darkest), each backend maps them to its own
+  // pixel format
+  virtual void DrawLine(
+      unsigned int ly, std::span<const std::uint8_t, SCREEN_WIDTH> shades) = 0;
   virtual void UpdateFrame() = 0;
 };
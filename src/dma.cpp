@@ -0,0 +1,118 @@
+#include "dma.hpp"
+
+#include <array>
+#include <span>
+
+#include "common.hpp"
+
+Dma::Dma(MemoryManagementUnit &mmu, Ppu &ppu, Scheduler &scheduler)
+    : _mmu(mmu), _ppu(ppu), _scheduler(scheduler)
+{
+  _scheduler.SetHandler(Scheduler::EventType::OamDmaEnd, [this]() {
+    _state.active = false;
+    _mmu.UnlockPages();
+  });
+}
+
+bool Dma::IsActive() const
+{
+  return _state.active;
+}
+
+bool Dma::Contains(std::uint16_t addr) const
+{
+  return addr == DMA_REGISTER_ADDRESS;
+}
+
+std::uint8_t Dma::Read(std::uint16_t addr) const
+{
+  if (addr != DMA_REGISTER_ADDRESS)
+  {
+    return 0xFF;
+  }
+  return _state.source;
+}
+
+void Dma::Write(std::uint16_t addr, std::uint8_t data)
+{
+  if (addr != DMA_REGISTER_ADDRESS)
+  {
+    return;
+  }
+  // a new transfer restarts the one in progress, the source has to be
+  // readable again before it's copied
+  _mmu.UnlockPages();
+  _state.source = data;
+  _state.active = true;
+  Transfer();
+  LockBus();
+  _scheduler.Schedule(
+      Scheduler::EventType::OamDmaEnd, _scheduler.Now() + TRANSFER_CYCLES);
+}
+
+std::uint8_t &Dma::Address(std::uint16_t addr)
+{
+  _register = Read(addr);
+  return _register;
+}
+
+void Dma::SaveState(SaveStateWriter &writer) const
+{
+  writer.Write(_state);
+}
+
+void Dma::LoadState(SaveStateReader &reader)
+{
+  reader.Read(_state);
+  _mmu.UnlockPages();
+  if (_state.active)
+  {
+    LockBus();
+  }
+}
+
+std::uint16_t Dma::SourceAddress() const
+{
+  auto page = _state.source >= 0xE0U ? _state.source - 0x20U : _state.source;
+  return static_cast<std::uint16_t>(page << 8U);
+}
+
+void Dma::Transfer()
+{
+  auto source = SourceAddress();
+  // the transfer never crosses a page, so it's one memcpy if the page is
+  // plain memory
+  if (const auto *memory = _mmu.PageMemory(source))
+  {
+    _ppu.WriteOam(std::span<const std::uint8_t, OAM_SIZE>{memory, OAM_SIZE});
+    return;
+  }
+
+  // io and banked memory without host memory go through the mmu
+  std::array<std::uint8_t, OAM_SIZE> data{};
+  for (std::uint16_t offset{0}; offset < OAM_SIZE; ++offset)
+  {
+    data[offset] = _mmu.Read(static_cast<std::uint16_t>(source + offset));
+  }
+  _ppu.WriteOam(data);
+}
+
+void Dma::LockBus()
+{
+  // oam and whichever bus the source is on, vram or the external bus
+  // (cartridge and work ram). hram and io registers stay reachable
+  constexpr std::uint16_t EXTERNAL_RAM_START{0xA000};
+  constexpr std::uint16_t EXTERNAL_BUS_END{0xFE00};
+  auto source = SourceAddress();
+  if (source >= VRAM_START_ADDRESS && source < VRAM_START_ADDRESS + VRAM_SIZE)
+  {
+    _mmu.LockPages(VRAM_START_ADDRESS, VRAM_SIZE);
+  }
+  else
+  {
+    _mmu.LockPages(0x0000, VRAM_START_ADDRESS);
+    _mmu.LockPages(
+        EXTERNAL_RAM_START, EXTERNAL_BUS_END - EXTERNAL_RAM_START);
+  }
+  _mmu.LockPages(OAM_START_ADDRESS, MemoryManagementUnit::PAGE_SIZE);
+}
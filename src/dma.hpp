@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+
+#include "memoryrange.hpp"
+#include "mmu.hpp"
+#include "ppu.hpp"
+#include "savestate.hpp"
+#include "scheduler.hpp"
+
+// OAM DMA register: 0xFF46
+// https://gbdev.io/pandocs/OAM_DMA_Transfer.html
+//
+// Writing XX copies 0xXX00 - 0xXX9F to oam. All 160 bytes are copied when
+// the register is written, with a single memcpy if the source page is plain
+// memory and through the mmu otherwise. For the 160 m-cycles the transfer
+// takes on hardware the cpu only sees 0xFF in oam and on the bus the
+// transfer reads from, the pages stay locked in the mmu until the
+// OamDmaEnd event.
+class Dma : public MemoryRange
+{
+public:
+  Dma(MemoryManagementUnit &mmu, Ppu &ppu, Scheduler &scheduler);
+
+  // true while a transfer keeps the bus locked
+  [[nodiscard]]
+  bool IsActive() const;
+
+  [[nodiscard]]
+  bool Contains(std::uint16_t addr) const override;
+
+  [[nodiscard]]
+  std::uint8_t Read(std::uint16_t addr) const override;
+
+  void Write(std::uint16_t addr, std::uint8_t data) override;
+
+  std::uint8_t &Address(std::uint16_t addr) override;
+
+  // The bus lockout of a transfer in progress is restored, call after
+  // loading the scheduler so the end of the transfer is pending again
+  void SaveState(SaveStateWriter &writer) const;
+  void LoadState(SaveStateReader &reader);
+
+private:
+  constexpr static std::uint64_t TRANSFER_CYCLES{160 * 4};
+
+  // First address the transfer reads from, 0xE0 - 0xFF read echo ram
+  [[nodiscard]]
+  std::uint16_t SourceAddress() const;
+
+  void Transfer();
+  void LockBus();
+
+  struct State
+  {
+    // last value written to the register
+    std::uint8_t source{0xFF};
+    bool active{};
+  };
+
+  MemoryManagementUnit &_mmu;
+  Ppu &_ppu;
+  Scheduler &_scheduler;
+  State _state;
+  // copy of the register handed out by Address, writes through it are lost
+  std::uint8_t _register{0xFF};
+};
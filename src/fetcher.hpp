@@ -1,24 +1,20 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
-#include <deque>
+#include <cstring>
 
 #include "bitutils.hpp"
 #include "common.hpp"
 #include "mmu.hpp"
+#include "pixelfifo.hpp"
+#include "savestate.hpp"
+#include "tiledecoder.hpp"
+#include "videoram.hpp"
 
 class Fetcher
 {
 public:
-  struct PixelFifoEntry
-  {
-    unsigned int x;
-    unsigned int y;
-    std::uint8_t color;
-    std::uint8_t palette;
-    std::uint8_t bgPriority;
-  };
-
   enum class FetcherState : std::uint8_t
   {
     GetTile,
@@ -28,177 +24,220 @@ public:
   };
 
 public:
-  explicit Fetcher(
-      MemoryManagementUnit &mmu, std::deque<PixelFifoEntry> &bgWinFiFo)
-      : _mmu{mmu}, _bgWinFifo(bgWinFiFo)
+  Fetcher(MemoryManagementUnit &mmu, VideoRam &vram,
+      PixelFifo &bgWinFiFo)
+      : _mmu{mmu}, _vram(vram), _bgWinFifo(bgWinFiFo)
   {
   }
 
   void Start()
   {
-    _state = FetcherState::GetTile;
-    _bgWinFifo.clear();
-    _clockDivider = 2;
-    _fetcherX = 0;
-    _ly = _mmu.Read(LY_REGISTER_ADDRESS);
-    _droppedInitialTile = false;
+    _state.fetcherState = FetcherState::GetTile;
+    _bgWinFifo.Clear();
+    _state.clockDivider = 2;
+    _state.fetcherX = 0;
+    _state.ly = _mmu.Read(LY_REGISTER_ADDRESS);
+    _state.droppedInitialTile = false;
+    _state.window = false;
+  }
+
+  // Switch to the window for the rest of the line, windowLine is the row of
+  // the window to draw. The fifo is refilled with the first two window tiles
+  // at once, so the pixels keep flowing without waiting for the fetcher
+  void StartWindow(unsigned int windowLine)
+  {
+    _state.window = true;
+    _state.windowLine = windowLine;
+    _state.fetcherX = 0;
+    _bgWinFifo.Clear();
+    auto lcdc = _mmu.Read(LCDC_REGISTER_ADDRESS);
+    for (int tile{0}; tile < 2; ++tile)
+    {
+      _state.tileIdx = ReadTileIndex(lcdc, 0, 0);
+      const auto *row = _vram.GetTileRow(
+          GetTileDataAddress(lcdc, _state.tileIdx, TileRow(0)));
+      std::memcpy(_state.tileRow.data(), row, _state.tileRow.size());
+      PushPixelToBgWinFifo();
+      ++_state.fetcherX;
+    }
+    _state.fetcherState = FetcherState::GetTile;
+    _state.clockDivider = 2;
+    _state.droppedInitialTile = true;
   }
 
   void Tick()
   {
-    // Fetcher is two times slower than PPU, so we use _clockDivider to properly
+    // Fetcher is two times slower than PPU, so we use clockDivider to properly
     // sync Fetcher and PPU
-    --_clockDivider;
-    if (_clockDivider > 0)
+    --_state.clockDivider;
+    if (_state.clockDivider > 0)
     {
       return;
     }
     else
     {
-      // Reset _clockDivider
-      _clockDivider = 2;
+      // Reset clockDivider
+      _state.clockDivider = 2;
     }
     auto scx = _mmu.Read(SCX_REGISTER_ADDRESS);
     auto scy = _mmu.Read(SCY_REGISTER_ADDRESS);
     auto lcdc = _mmu.Read(LCDC_REGISTER_ADDRESS);
-    switch (_state)
+    switch (_state.fetcherState)
     {
       case FetcherState::GetTile:
       {
-        // TODO: Also consider window and sprites
-        auto tileToFetchX = ((scx / 8U) + _fetcherX) & 0x1FU;  // 0x1F = 31
-        auto tileToFetchY = (((_ly + scy) & 0xFFU) / 8);       // 0xFF = 255
-        auto bgtileIdx =
-            (BG_WIN_TILEMAP_ROW_SIZE * tileToFetchY) + tileToFetchX;
-        if (BitUtils::Test<3>(
-                lcdc))  // if LCDC bit 3 is set use tile map 0x9C00-0x9FFF
-        {
-          _tileIdx = _mmu.Read(
-              static_cast<std::uint16_t>(BG_WIN_TILEMAP_ADDRESS1 + bgtileIdx));
-        }
-        else
-        {
-          _tileIdx = _mmu.Read(
-              static_cast<std::uint16_t>(BG_WIN_TILEMAP_ADDRESS0 + bgtileIdx));
-        }
-        _state = FetcherState::GetTileData0;
+        _state.tileIdx = ReadTileIndex(lcdc, scx, scy);
+        _state.fetcherState = FetcherState::GetTileData0;
         break;
       }
       case FetcherState::GetTileData0:
       {
-        // TODO: Take Window into consideration
-        std::uint16_t tileDataLowAddress{};
-        if (BitUtils::Test<4>(lcdc))  // if lcdc bit 4 is set use tile data map
-                                      // starting at 0x8000 - 0x8FFF
-        {
-          tileDataLowAddress = static_cast<std::uint16_t>(
-              BG_WIN_TILEDATA_ADDRESS1 + (_tileIdx * TILE_DATA_SIZE)
-              + (((_ly + scy) & 0x7U) * 2));
-        }
-        else  // else use tile data map at 0x8800 - 0x97FF
-        {
-          tileDataLowAddress = static_cast<std::uint16_t>(
-              BG_WIN_TILEDATA_ADDRESS0
-              + (static_cast<int>(_tileIdx) * static_cast<int>(TILE_DATA_SIZE))
-              + static_cast<int>(((_ly + scy) & 0x7U)));
-        }
-        _tileDataLow = _mmu.Read(tileDataLowAddress);
-        _state = FetcherState::GetTileData1;
+        _state.tileDataAddress =
+            GetTileDataAddress(lcdc, _state.tileIdx, TileRow(scy));
+        _state.fetcherState = FetcherState::GetTileData1;
         break;
       }
       case FetcherState::GetTileData1:
       {
-        // TODO: Take Window into consideration
-        std::uint16_t tileDataHighAddress{};
-        if (BitUtils::Test<4>(lcdc))  // if lcdc bit 4 is set use tile data map
-                                      // starting at 0x8000 - 0x8FFF
-        {
-          tileDataHighAddress = static_cast<std::uint16_t>(
-              BG_WIN_TILEDATA_ADDRESS1 + (_tileIdx * TILE_DATA_SIZE)
-              + (((_ly + scy) & 0x7U) * 2) + 1);
-        }
-        else  // else use tile data map at 0x8800 - 0x97FF
-        {
-          tileDataHighAddress = static_cast<std::uint16_t>(
-              BG_WIN_TILEDATA_ADDRESS0
-              + (static_cast<int>(_tileIdx) * static_cast<int>(TILE_DATA_SIZE))
-              + static_cast<int>((((_ly + scy) & 0x7U) * 2)) + 1);
-        }
-        _tileDataHigh = _mmu.Read(tileDataHighAddress);
-        if (_bgWinFifo.size() <= 8)
+        // both bytes of the row come decoded from the tile cache
+        std::memcpy(_state.tileRow.data(),
+            _vram.GetTileRow(_state.tileDataAddress), _state.tileRow.size());
+        if (_bgWinFifo.Size() <= 8)
         {
           PushPixelToBgWinFifo();
-          if (_droppedInitialTile)
+          if (_state.droppedInitialTile)
           {
-            ++_fetcherX;
+            ++_state.fetcherX;
           }
           else
           {
-            _droppedInitialTile = true;
+            _state.droppedInitialTile = true;
           }
-          _state = FetcherState::GetTile;
+          _state.fetcherState = FetcherState::GetTile;
         }
         else
         {
-          _state = FetcherState::PushPixel;
+          _state.fetcherState = FetcherState::PushPixel;
         }
         break;
       }
       case FetcherState::PushPixel:
       {
         // TODO:
-        if (_bgWinFifo.size() <= 8)
+        if (_bgWinFifo.Size() <= 8)
         {
           PushPixelToBgWinFifo();
-          if (_droppedInitialTile)
+          if (_state.droppedInitialTile)
           {
-            ++_fetcherX;
+            ++_state.fetcherX;
           }
           else
           {
-            _droppedInitialTile = true;
+            _state.droppedInitialTile = true;
           }
-          _state = FetcherState::GetTile;
+          _state.fetcherState = FetcherState::GetTile;
         }
         break;
       }
     }
   }
 
+  void SaveState(SaveStateWriter &writer) const
+  {
+    writer.Write(_state);
+  }
+
+  void LoadState(SaveStateReader &reader)
+  {
+    reader.Read(_state);
+  }
+
+  // Address of the low byte of a row of a background/window tile
+  [[nodiscard]]
+  static std::uint16_t GetTileDataAddress(
+      std::uint8_t lcdc, std::uint8_t tileIdx, unsigned int row)
+  {
+    if (BitUtils::Test<4>(lcdc))  // if lcdc bit 4 is set use tile data map
+                                  // starting at 0x8000 - 0x8FFF
+    {
+      return static_cast<std::uint16_t>(
+          BG_WIN_TILEDATA_ADDRESS1 + (tileIdx * TILE_DATA_SIZE) + (row * 2));
+    }
+    // else use tile data map at 0x8800 - 0x97FF, tile index is signed
+    return static_cast<std::uint16_t>(BG_WIN_TILEDATA_ADDRESS0
+                                      + (static_cast<std::int8_t>(tileIdx)
+                                         * static_cast<int>(TILE_DATA_SIZE))
+                                      + static_cast<int>(row * 2));
+  }
+
 private:
+  // Tile map entry of the tile at fetcherX, the background and the window
+  // have their own tile map bit in LCDC
+  [[nodiscard]]
+  std::uint8_t ReadTileIndex(
+      std::uint8_t lcdc, std::uint8_t scx, std::uint8_t scy) const
+  {
+    unsigned int tileX{};
+    unsigned int tileY{};
+    bool highTileMap{};
+    if (_state.window)
+    {
+      tileX = _state.fetcherX & 0x1FU;
+      tileY = _state.windowLine / 8;
+      highTileMap = BitUtils::Test<6>(lcdc);
+    }
+    else
+    {
+      tileX = ((scx / 8U) + _state.fetcherX) & 0x1FU;  // 0x1F = 31
+      tileY = ((_state.ly + scy) & 0xFFU) / 8;         // 0xFF = 255
+      highTileMap = BitUtils::Test<3>(lcdc);
+    }
+    // tile map 0x9C00-0x9FFF if the bit is set, else 0x9800-0x9BFF
+    return _vram.ReadTileMap(static_cast<std::uint16_t>(
+        (highTileMap ? BG_WIN_TILEMAP_ADDRESS1 : BG_WIN_TILEMAP_ADDRESS0)
+        + (BG_WIN_TILEMAP_ROW_SIZE * tileY) + tileX));
+  }
+
+  // Row of the fetched tile that is on this line
+  [[nodiscard]]
+  unsigned int TileRow(std::uint8_t scy) const
+  {
+    return (_state.window ? _state.windowLine : _state.ly + scy) & 0x7U;
+  }
+
   void PushPixelToBgWinFifo()
   {
-    if (_bgWinFifo.size() > 8)
+    if (_bgWinFifo.Size() > 8)
     {
       return;
     }
-    for (unsigned int i{0}; i < 8; ++i)
+    for (auto colorId : _state.tileRow)
     {
-      unsigned int bitIndex = 7U - i;
-      unsigned int bit1 =
-          (static_cast<unsigned int>(_tileDataLow) >> bitIndex) & 1U;
-      unsigned int bit2 =
-          (static_cast<unsigned int>(_tileDataHigh) >> bitIndex) & 1U;
-      auto colorId = static_cast<std::uint8_t>((bit2 << 1U) | bit1);
-      unsigned int screenX = (_fetcherX * 8) + i;
-      auto entry = PixelFifoEntry{.x = screenX,
-          .y = _ly,
-          .color = colorId,
-          .palette = {},
-          .bgPriority = {}};
-      _bgWinFifo.emplace_back(entry);
+      _bgWinFifo.Push({.color = static_cast<std::uint8_t>(colorId & 0x3U),
+          .palette = 0,
+          .bgPriority = 0});
     }
   }
 
+  struct State
+  {
+    int clockDivider{};
+    unsigned int fetcherX{};
+    unsigned int ly{};
+    FetcherState fetcherState{};
+    // Index of the tile to fetch from background/window tile map
+    std::uint8_t tileIdx{};
+    std::uint16_t tileDataAddress{};
+    // color ids of the fetched tile row
+    std::array<std::uint8_t, TileDecoder::DECODED_ROW_SIZE> tileRow{};
+    bool droppedInitialTile{};
+    // fetching window tiles instead of background tiles
+    bool window{};
+    unsigned int windowLine{};
+  };
+
   MemoryManagementUnit &_mmu;
-  std::deque<PixelFifoEntry> &_bgWinFifo;
-  int _clockDivider{};
-  unsigned int _fetcherX{};
-  unsigned int _ly{};
-  FetcherState _state{};
-  // Index of the tile to fetch from background/window tile map
-  unsigned int _tileIdx{};
-  std::uint8_t _tileDataLow{};
-  std::uint8_t _tileDataHigh{};
-  bool _droppedInitialTile{};
+  VideoRam &_vram;
+  PixelFifo &_bgWinFifo;
+  State _state;
 };
@@ -1,31 +1,21 @@
 #include "filememoryrange.hpp"
 
-#include <format>
-#include <fstream>
+#include <utility>
 
 void FileMemoryRange::Load(const std::string &filePath, std::size_t offset)
 {
-  _offset = offset;
-
-  // open file
-  std::ifstream file{filePath, std::ios::binary | std::ios::ate};
-  if (!file.is_open())
-  {
-    throw std::runtime_error(std::format("Failed to open rom: {}", filePath));
-  }
-  auto size = file.tellg();
-  file.seekg(0, std::ios::beg);
-  _memory.resize(static_cast<std::size_t>(size));
+  Load(RomImage::Open(filePath), offset);
+}
 
-  // read file to memory
-  file.read(reinterpret_cast<char *>(_memory.data()), size);
-  if (_memory.empty())
-  {
-    throw std::runtime_error("Failed to read rom");
-  }
+void FileMemoryRange::Load(
+    std::shared_ptr<const RomImage> image, std::size_t offset)
+{
+  _offset = offset;
+  _image = std::move(image);
+  _memory = _image->Data();
 }
 
-FileMemoryRange::FileMemoryRange() : _memory{}, _offset{}
+FileMemoryRange::FileMemoryRange() : _offset{}
 {
 }
 
@@ -37,7 +27,7 @@ bool FileMemoryRange::Contains(std::uint16_t addr) const
 std::uint8_t FileMemoryRange::Read(std::uint16_t addr) const
 {
   // return data from memroy if memory range contains the address
-  if (Contains(addr))
+  if (FileMemoryRange::Contains(addr))
   {
     // adjust address by substracting the offset
     return _memory[addr - _offset];
@@ -47,27 +37,23 @@ std::uint8_t FileMemoryRange::Read(std::uint16_t addr) const
   return 0xFF;
 }
 
-void FileMemoryRange::Write(std::uint16_t addr, std::uint8_t data)
+void FileMemoryRange::Write(
+    [[maybe_unused]] std::uint16_t addr, [[maybe_unused]] std::uint8_t data)
 {
-  // write to memory only if address is contained in memory range
-  if (Contains(addr))
-  {
-    // adjust the addr by substracting the offset
-    _memory[addr - _offset] = data;
-  }
+  // the image is read only, writes to rom never change it
 }
 
 std::uint8_t &FileMemoryRange::Address(std::uint16_t addr)
 {
-  // return data from memroy if memory range contains the address
-  if (Contains(addr))
-  {
-    // adjust address by substracting the offset
-    return _memory[addr - _offset];
-  }
+  _unmapped = Read(addr);
+  return _unmapped;
+}
 
-  // return dummy value if memory range does not contain addr
-  static std::uint8_t dummy;
-  dummy = 0xFF;
-  return dummy;
+MemoryRange::Storage FileMemoryRange::GetStorage()
+{
+  // writable is false, so the mmu never writes through data
+  return {.data = const_cast<std::uint8_t *>(_memory.data()),
+      .offset = _offset,
+      .size = _memory.size(),
+      .writable = false};
 }
@@ -1,11 +1,17 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
 #include <string>
-#include <vector>
 
-#include "concretememoryrange.hpp"
 #include "memoryrange.hpp"
+#include "romimage.hpp"
 
+// Read only memory range backed by a rom image. The image can be shared by
+// any number of ranges (and machines), it's never written to: writes to rom
+// addresses are mapper control, not data
 class FileMemoryRange : public MemoryRange
 {
 public:
@@ -19,11 +25,20 @@ public:
 
   void Write(std::uint16_t addr, std::uint8_t data) override;
 
+  // Rom can't be written, so this hands out a copy of the byte and writes
+  // through it are lost
   std::uint8_t &Address(std::uint16_t addr) override;
 
+  [[nodiscard]]
+  Storage GetStorage() override;
+
   void Load(const std::string &filePath, std::size_t offset);
+  void Load(std::shared_ptr<const RomImage> image, std::size_t offset);
 
 private:
-  std::vector<std::uint8_t> _memory;
+  std::shared_ptr<const RomImage> _image;
+  std::span<const std::uint8_t> _memory;
   std::size_t _offset;
+  // byte handed out by Address
+  std::uint8_t _unmapped{0xFF};
 };
@@ -0,0 +1,49 @@
+#include "framepacer.hpp"
+
+#include <thread>
+
+FramePacer::FramePacer(double speed) : _speed(0), _nextFrame(Clock::now())
+{
+  SetSpeed(speed);
+}
+
+void FramePacer::SetSpeed(double speed)
+{
+  _speed = speed > 0 ? speed : 0;
+  if (_speed > 0)
+  {
+    _frameDuration = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double, std::nano>(
+            static_cast<double>(FRAME_DURATION.count()) / _speed));
+  }
+  // start pacing from now, the old deadline belongs to the old speed
+  _nextFrame = Clock::now();
+}
+
+double FramePacer::GetSpeed() const
+{
+  return _speed;
+}
+
+void FramePacer::WaitForNextFrame()
+{
+  if (_speed <= 0)
+  {
+    return;
+  }
+  _nextFrame += _frameDuration;
+  auto now = Clock::now();
+  if (now > _nextFrame + MAX_LAG)
+  {
+    _nextFrame = now;
+    return;
+  }
+  if (_nextFrame - now > SPIN_TIME)
+  {
+    std::this_thread::sleep_for(_nextFrame - now - SPIN_TIME);
+  }
+  while (Clock::now() < _nextFrame)
+  {
+    std::this_thread::yield();
+  }
+}
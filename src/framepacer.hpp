@@ -0,0 +1,37 @@
+#pragma once
+
+#include <chrono>
+
+// Keeps emulated frames in step with real time. WaitForNextFrame is called
+// once per emulated frame (at vblank) and returns when that frame is due.
+// It sleeps for most of the wait and spins for the last stretch, since sleeps
+// can overshoot by a good part of a millisecond
+class FramePacer
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  // 70224 cycles per frame at 4194304 Hz, i.e 59.7275 frames/s
+  constexpr static std::chrono::nanoseconds FRAME_DURATION{16742706};
+
+  // speed is a multiplier of real time, 0 runs uncapped
+  explicit FramePacer(double speed);
+
+  void SetSpeed(double speed);
+
+  [[nodiscard]]
+  double GetSpeed() const;
+
+  void WaitForNextFrame();
+
+private:
+  // sleep until this long before the deadline, then spin
+  constexpr static std::chrono::microseconds SPIN_TIME{1500};
+  // if we fall further behind than this (host too slow, debugger, window
+  // dragged) don't try to catch up by running frames back to back
+  constexpr static std::chrono::milliseconds MAX_LAG{100};
+
+  double _speed;
+  Clock::duration _frameDuration{};
+  Clock::time_point _nextFrame;
+};
@@ -0,0 +1,296 @@
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "batchrunner.hpp"
+#include "display.hpp"
+#include "framepacer.hpp"
+#include "logmanager.hpp"
+#include "machine.hpp"
+#include "memorydisplay.hpp"
+#include "movie.hpp"
+#include "nulldisplay.hpp"
+#include "ppu.hpp"
+
+namespace
+{
+// Jobs file of --batch: one job per line, "<bootrom> <rom> <frames> [movie]".
+// Frames can be 0 when a movie is given. Empty lines and lines starting with
+// # are skipped
+std::vector<BatchJob> LoadJobs(
+    const std::string &filePath, Ppu::RenderMode renderMode)
+{
+  std::ifstream file{filePath};
+  if (!file)
+  {
+    throw std::runtime_error(std::format("Can't open jobs file: {}", filePath));
+  }
+  std::vector<BatchJob> jobs;
+  std::string line;
+  for (int lineNumber{1}; std::getline(file, line); ++lineNumber)
+  {
+    if (line.empty() || line.front() == '#')
+    {
+      continue;
+    }
+    std::istringstream fields{line};
+    BatchJob job;
+    job.renderMode = renderMode;
+    if (!(fields >> job.bootRomPath >> job.romPath >> job.frames))
+    {
+      throw std::runtime_error(
+          std::format("Invalid job at {}:{}", filePath, lineNumber));
+    }
+    fields >> job.moviePath;
+    jobs.push_back(std::move(job));
+  }
+  return jobs;
+}
+
+// Run the jobs of a jobs file on all threads, print the last frame hash of
+// every job in order
+int RunBatch(std::span<char *> args,
+    const std::shared_ptr<spdlog::logger> &logger)
+{
+  unsigned int threadCount{};
+  auto renderMode = Ppu::RenderMode::Dot;
+  for (std::size_t i{1}; i < args.size(); ++i)
+  {
+    std::string_view arg{args[i]};
+    if (arg == "--threads" && i + 1 < args.size())
+    {
+      std::string_view value{args[++i]};
+      auto [ptr, ec] = std::from_chars(
+          value.data(), value.data() + value.size(), threadCount);
+      if (ec != std::errc{} || ptr != value.data() + value.size())
+      {
+        LOG_CRITICAL(logger, "Invalid thread count: {}\n", value);
+        return 1;
+      }
+    }
+    else if (arg == "--scanline")
+    {
+      renderMode = Ppu::RenderMode::Scanline;
+    }
+    else
+    {
+      LOG_WARN(logger, "Ignoring unknown option: {}\n", arg);
+    }
+  }
+
+  auto jobs = LoadJobs(args[0], renderMode);
+  BatchRunner runner{threadCount};
+  auto start = std::chrono::steady_clock::now();
+  auto results = runner.Run(jobs);
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  int exitCode{0};
+  std::uint64_t frames{};
+  for (std::size_t i{0}; i < results.size(); ++i)
+  {
+    if (!results[i].error.empty())
+    {
+      std::cout << std::format("job {} error {}\n", i, results[i].error);
+      exitCode = 1;
+      continue;
+    }
+    std::cout << std::format("job {} frame {} {:016x}\n", i,
+        results[i].frames, results[i].frameHash);
+    frames += results[i].frames;
+  }
+  LOG_INFO(logger,
+      "Ran {} jobs, {} frames on {} threads in {:.3f}s ({:.1f} frames/s)\n",
+      jobs.size(), frames, runner.ThreadCount(), elapsed.count(),
+      static_cast<double>(frames) / elapsed.count());
+  return exitCode;
+}
+}  // namespace
+
+// Frontend without any window, for batch jobs and regression runs.
+// Usage: NoobBoyHeadless <bootrom> <rom> [--frames N] [--turbo] [--speed N]
+//                        [--scanline] [--hash] [--replay FILE] [--save FILE]
+//        NoobBoyHeadless --batch <jobs> [--threads N] [--scanline]
+//   --frames N  stop after N frames, runs until killed if not given
+//   --turbo     run as fast as possible instead of at 59.7275 frames/s
+//   --speed N   run at N times the gameboy's speed, 0 is the same as --turbo
+//   --scanline  render whole lines at the start of hblank
+//   --hash      print a hash of every frame to stdout
+//   --replay F  play the input of movie F, stops at its end unless --frames
+//               is given
+//   --save F    keep battery backed cartridge ram in save file F, not with
+//               --replay
+//   --batch J   run every job of jobs file J uncapped, spread over all cores
+//   --threads N threads running batch jobs, one per core if not given
+int main(int argc, char **argv)
+{
+  LogManager::InitLogging(GB_LOG_LEVEL, "log.txt");
+  auto logger = LogManager::GetLogger("main");
+  if (argc >= 3 && std::string_view{argv[1]} == "--batch")
+  {
+    int exitCode{1};
+    try
+    {
+      exitCode = RunBatch(
+          std::span{argv + 2, static_cast<std::size_t>(argc - 2)}, logger);
+    }
+    catch (std::exception &ex)
+    {
+      LOG_CRITICAL(logger, "{}\n", ex.what());
+    }
+    LogManager::ShutdownLogging();
+    return exitCode;
+  }
+
+  // early exit if no rom present
+  if (argc < 3)
+  {
+    LOG_CRITICAL(logger, "No rom paths provided\n");
+    return 1;
+  }
+
+  std::uint64_t frames{};
+  double speed{1.0};
+  bool hash{false};
+  std::string replayPath;
+  std::string savePath;
+  auto renderMode = Ppu::RenderMode::Dot;
+  for (int i{3}; i < argc; ++i)
+  {
+    std::string_view arg{argv[i]};
+    if (arg == "--frames" && i + 1 < argc)
+    {
+      std::string_view value{argv[++i]};
+      auto [ptr, ec] =
+          std::from_chars(value.data(), value.data() + value.size(), frames);
+      if (ec != std::errc{} || ptr != value.data() + value.size())
+      {
+        LOG_CRITICAL(logger, "Invalid frame count: {}\n", value);
+        return 1;
+      }
+    }
+    else if (arg == "--turbo")
+    {
+      speed = 0;
+    }
+    else if (arg == "--speed" && i + 1 < argc)
+    {
+      std::string_view value{argv[++i]};
+      auto [ptr, ec] =
+          std::from_chars(value.data(), value.data() + value.size(), speed);
+      if (ec != std::errc{} || ptr != value.data() + value.size() || speed < 0)
+      {
+        LOG_CRITICAL(logger, "Invalid speed: {}\n", value);
+        return 1;
+      }
+    }
+    else if (arg == "--scanline")
+    {
+      renderMode = Ppu::RenderMode::Scanline;
+    }
+    else if (arg == "--hash")
+    {
+      hash = true;
+    }
+    else if (arg == "--replay" && i + 1 < argc)
+    {
+      replayPath = argv[++i];
+    }
+    else if (arg == "--save" && i + 1 < argc)
+    {
+      savePath = argv[++i];
+    }
+    else
+    {
+      LOG_WARN(logger, "Ignoring unknown option: {}\n", arg);
+    }
+  }
+
+  // movies replay from power on with cleared cartridge ram, a save file would
+  // start them from a different state
+  if (!replayPath.empty() && !savePath.empty())
+  {
+    LOG_CRITICAL(logger, "--replay can't be combined with --save\n");
+    return 1;
+  }
+
+  // frames only need to be kept if they are hashed
+  std::unique_ptr<Display> display;
+  MemoryDisplay *memoryDisplay{};
+  if (hash)
+  {
+    auto ownedDisplay = std::make_unique<MemoryDisplay>(true);
+    memoryDisplay = ownedDisplay.get();
+    display = std::move(ownedDisplay);
+  }
+  else
+  {
+    display = std::make_unique<NullDisplay>();
+  }
+
+  int exitCode{0};
+  try
+  {
+    // argv[1] is the bootrom, argv[2] the game rom
+    Machine machine{argv[1], argv[2], *display, renderMode};
+    if (!savePath.empty() && !machine.UseSaveFile(savePath))
+    {
+      LOG_WARN(logger, "Cartridge has no battery backed ram, not saving\n");
+    }
+    Movie replay;
+    if (!replayPath.empty())
+    {
+      replay = Movie::Load(replayPath);
+      if (frames == 0)
+      {
+        frames = replay.FrameCount();
+      }
+    }
+
+    FramePacer pacer{speed};
+    // cartridge ram changes reach the disk every 60 frames
+    constexpr std::uint64_t SAVE_FLUSH_INTERVAL{60};
+    auto start = std::chrono::steady_clock::now();
+    while (frames == 0 || machine.FrameCount() < frames)
+    {
+      machine.SetButtons(replay.ButtonsAt(machine.FrameCount()));
+      machine.RunFrame();
+      if (machine.FrameCount() % SAVE_FLUSH_INTERVAL == 0)
+      {
+        machine.FlushSaveFile();
+      }
+      if (memoryDisplay != nullptr)
+      {
+        std::cout << std::format("frame {} {:016x}\n", machine.FrameCount(),
+            memoryDisplay->GetFrameHash());
+      }
+      pacer.WaitForNextFrame();
+    }
+
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    LOG_INFO(logger, "Ran {} frames in {:.3f}s ({:.1f} frames/s)\n",
+        machine.FrameCount(), elapsed.count(),
+        static_cast<double>(machine.FrameCount()) / elapsed.count());
+  }
+  catch (std::exception &ex)
+  {
+    LOG_CRITICAL(logger, "{}\n", ex.what());
+    exitCode = 1;
+  }
+  LogManager::ShutdownLogging();
+  return exitCode;
+}
@@ -0,0 +1,154 @@
+#include "idleloopdetector.hpp"
+
+#include <algorithm>
+#include <limits>
+
+#include "common.hpp"
+
+IdleLoopDetector::IdleLoopDetector(const MemoryManagementUnit &mmu)
+    : _mmu(mmu)
+{
+}
+
+void IdleLoopDetector::OnBackwardJump(
+    const CpuState &state, std::uint16_t loopEnd, Scheduler &scheduler)
+{
+  auto now = scheduler.Now();
+  if (!_started || !IsSameState(state, _state))
+  {
+    _started = true;
+    _state = state;
+    _cycle = now;
+    return;
+  }
+
+  // the iteration that just ended changed nothing, if it only read LY and
+  // STAT the ones up to the next event do the same
+  auto iteration = now - _cycle;
+  _cycle = now;
+  if (scheduler.IsEventDue() || !scheduler.HasPendingEvent()
+      || !IsIdleLoop(state.PC.reg, loopEnd))
+  {
+    return;
+  }
+  // whole iterations only, the last skipped one ends at the event at the
+  // latest so the event runs between the same instructions as without skip.
+  // An event too far off for one int is reached over several skips
+  auto iterations = std::min((scheduler.NextEventTime() - now) / iteration,
+      std::numeric_limits<int>::max() / iteration);
+  scheduler.Advance(static_cast<int>(iterations * iteration));
+  _cycle = scheduler.Now();
+}
+
+void IdleLoopDetector::Reset()
+{
+  _started = false;
+}
+
+unsigned int IdleLoopDetector::IdleInstructionSize(
+    std::uint16_t addr, std::uint16_t start, std::uint16_t end) const
+{
+  auto opcode = _mmu.Read(addr);
+  auto operand = _mmu.Read(static_cast<std::uint16_t>(addr + 1));
+  // register 6 is (HL), an unknown address
+  auto source = opcode & 0x07U;
+  auto destination = (opcode >> 3U) & 0x07U;
+
+  if (opcode == 0x00)
+  {
+    // NOP
+    return 1;
+  }
+  if (opcode == 0x18 || opcode == 0x20 || opcode == 0x28 || opcode == 0x30
+      || opcode == 0x38)
+  {
+    // JR, jumps leaving the loop could get back through unchecked code
+    auto target = addr + 2 + static_cast<std::int8_t>(operand);
+    return target >= start && target < end ? 2 : 0;
+  }
+  if (opcode < 0x40)
+  {
+    switch (opcode & 0x07U)
+    {
+      case 0x04:
+      case 0x05:
+        // INC r, DEC r
+        return destination != 6 ? 1 : 0;
+      case 0x06:
+        // LD r, u8
+        return destination != 6 ? 2 : 0;
+      case 0x07:
+        // RLCA, RRCA, RLA, RRA, DAA, CPL, SCF, CCF
+        return 1;
+      default:
+        return 0;
+    }
+  }
+  if (opcode < 0x80)
+  {
+    // LD r, r and HALT
+    return opcode != 0x76 && source != 6 && destination != 6 ? 1 : 0;
+  }
+  if (opcode < 0xC0)
+  {
+    // alu A, r
+    return source != 6 ? 1 : 0;
+  }
+  if ((opcode & 0xC7U) == 0xC6)
+  {
+    // alu A, u8
+    return 2;
+  }
+  if (opcode == 0xCB)
+  {
+    // rotates, shifts and bit operations on a register
+    return (operand & 0x07U) != 6 ? 2 : 0;
+  }
+  if (opcode == 0xF0)
+  {
+    // LDH A, (u8)
+    auto ioAddr = static_cast<std::uint16_t>(0xFF00 | operand);
+    return ioAddr == LY_REGISTER_ADDRESS || ioAddr == LCD_STAT_REGISTER_ADDRESS
+               ? 2
+               : 0;
+  }
+  if (opcode == 0xFA)
+  {
+    // LD A, (u16)
+    auto high = _mmu.Read(static_cast<std::uint16_t>(addr + 2));
+    auto srcAddr = static_cast<std::uint16_t>(operand | (high << 8U));
+    return srcAddr == LY_REGISTER_ADDRESS
+                   || srcAddr == LCD_STAT_REGISTER_ADDRESS
+               ? 3
+               : 0;
+  }
+  return 0;
+}
+
+bool IdleLoopDetector::IsIdleLoop(std::uint16_t start, std::uint16_t end) const
+{
+  if (end <= start || end - start > MAX_LOOP_SIZE)
+  {
+    return false;
+  }
+  unsigned int addr{start};
+  while (addr < end)
+  {
+    auto size =
+        IdleInstructionSize(static_cast<std::uint16_t>(addr), start, end);
+    if (size == 0)
+    {
+      return false;
+    }
+    addr += size;
+  }
+  return addr == end;
+}
+
+bool IdleLoopDetector::IsSameState(const CpuState &a, const CpuState &b)
+{
+  return a.AF.reg == b.AF.reg && a.BC.reg == b.BC.reg && a.DE.reg == b.DE.reg
+         && a.HL.reg == b.HL.reg && a.SP.reg == b.SP.reg
+         && a.PC.reg == b.PC.reg && a.halted == b.halted
+         && a.haltBug == b.haltBug;
+}
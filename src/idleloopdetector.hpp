@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+
+#include "cpu.hpp"
+#include "mmu.hpp"
+#include "scheduler.hpp"
+
+// Skips busy waits polling LY or STAT, like
+//
+//   loop: LDH A, (0x44)
+//         CP 0x90
+//         JR NZ, loop
+//
+// Both registers only change when a scheduled event runs. A loop that writes
+// nothing, reads no memory but them and gets back to its start with the cpu
+// state it started with repeats exactly the same way until the next event.
+// Once an iteration like that is seen, the detector advances over as many
+// more of them as fit before the event instead of running them.
+class IdleLoopDetector
+{
+public:
+  explicit IdleLoopDetector(const MemoryManagementUnit &mmu);
+
+  // Call after the cpu took a backward relative jump to the start of a loop,
+  // state is the cpu state there and loopEnd the address after the jump
+  void OnBackwardJump(
+      const CpuState &state, std::uint16_t loopEnd, Scheduler &scheduler);
+
+  // Forget the iteration seen last, call whenever events ran since they may
+  // have changed what the loop reads
+  void Reset();
+
+private:
+  // longest loop that's checked, idle loops are a few instructions
+  constexpr static std::uint16_t MAX_LOOP_SIZE{32};
+
+  // Size of the instruction at addr if it can be part of an idle loop from
+  // start to end, 0 otherwise
+  [[nodiscard]]
+  unsigned int IdleInstructionSize(
+      std::uint16_t addr, std::uint16_t start, std::uint16_t end) const;
+
+  // true if every instruction from start to end can be part of an idle loop
+  [[nodiscard]]
+  bool IsIdleLoop(std::uint16_t start, std::uint16_t end) const;
+
+  [[nodiscard]]
+  static bool IsSameState(const CpuState &a, const CpuState &b);
+
+  const MemoryManagementUnit &_mmu;
+  // cpu state and cycle at the start of the last iteration
+  bool _started{};
+  CpuState _state{};
+  std::uint64_t _cycle{};
+};
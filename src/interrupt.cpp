@@ -60,7 +60,24 @@ std::uint8_t &Interrupt::Address(std::uint16_t addr)
   // if address is not presesnt, return dummy value
   LOG_TRACE(
       _logger, "Trying to read invalid address: {}, returning 0xFF", addr);
-  static std::uint8_t dummy;
-  dummy = 0xFF;
-  return dummy;
+  _unmapped = 0xFF;
+  return _unmapped;
+}
+
+void Interrupt::SaveState(SaveStateWriter &writer) const
+{
+  writer.Write(State{.ime = _ime,
+      .enableRequested = _enableRequested,
+      .ie = _ie,
+      .iflag = _if});
+}
+
+void Interrupt::LoadState(SaveStateReader &reader)
+{
+  State state{};
+  reader.Read(state);
+  _ime = state.ime;
+  _enableRequested = state.enableRequested;
+  _ie = state.ie;
+  _if = state.iflag;
 }
@@ -5,6 +5,7 @@
 #include <memory>
 
 #include "memoryrange.hpp"
+#include "savestate.hpp"
 
 class Cpu;
 
@@ -32,7 +33,18 @@ public:
 
   std::uint8_t &Address(std::uint16_t addr) override;
 
+  void SaveState(SaveStateWriter &writer) const;
+  void LoadState(SaveStateReader &reader);
+
 private:
+  struct State
+  {
+    bool ime;
+    bool enableRequested;
+    std::uint8_t ie;
+    std::uint8_t iflag;
+  };
+
   friend class Cpu;
 
   // This field determines if interrupts are enabled or disabled
@@ -44,5 +56,7 @@ private:
   // IF register:
   // https://gbdev.io/pandocs/Interrupts.html#ff0f--if-interrupt-flag
   std::uint8_t _if;
+  // handed out by Address for addresses other than IE and IF
+  std::uint8_t _unmapped{0xFF};
   std::shared_ptr<spdlog::logger> _logger{};
 };
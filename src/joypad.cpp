@@ -0,0 +1,82 @@
+#include "joypad.hpp"
+
+#include "common.hpp"
+#include "interrupt.hpp"
+
+Joypad::Joypad(MemoryManagementUnit &mmu) : _mmu(mmu)
+{
+}
+
+void Joypad::SetButtons(std::uint8_t buttons)
+{
+  _state.buttons = buttons;
+  UpdateInputLines();
+}
+
+bool Joypad::Contains(std::uint16_t addr) const
+{
+  return addr == JOYPAD_REGISTER_ADDRESS;
+}
+
+std::uint8_t Joypad::Read(std::uint16_t addr) const
+{
+  if (addr != JOYPAD_REGISTER_ADDRESS)
+  {
+    return 0xFF;
+  }
+  // bits 6 and 7 are unused and read as 1
+  return static_cast<std::uint8_t>(0xC0U | _state.select | InputLines());
+}
+
+void Joypad::Write(std::uint16_t addr, std::uint8_t data)
+{
+  if (addr != JOYPAD_REGISTER_ADDRESS)
+  {
+    return;
+  }
+  // only the select bits are writable
+  _state.select = static_cast<std::uint8_t>(data & 0x30U);
+  UpdateInputLines();
+}
+
+std::uint8_t &Joypad::Address(std::uint16_t addr)
+{
+  _register = Read(addr);
+  return _register;
+}
+
+void Joypad::SaveState(SaveStateWriter &writer) const
+{
+  writer.Write(_state);
+}
+
+void Joypad::LoadState(SaveStateReader &reader)
+{
+  reader.Read(_state);
+}
+
+std::uint8_t Joypad::InputLines() const
+{
+  unsigned int lines{0x0F};
+  if ((_state.select & 0x10U) == 0)
+  {
+    // d-pad is in the low nibble of the mask
+    lines &= ~(_state.buttons & 0x0FU);
+  }
+  if ((_state.select & 0x20U) == 0)
+  {
+    // a, b, select and start are in the high nibble
+    lines &= ~(_state.buttons >> 4U);
+  }
+  return static_cast<std::uint8_t>(lines & 0x0FU);
+}
+
+void Joypad::UpdateInputLines()
+{
+  auto lines = InputLines();
+  if ((_state.inputLines & ~lines & 0x0FU) != 0)
+  {
+    _mmu.RequestInterrupt(InterruptType::JOYPAD);
+  }
+  _state.inputLines = lines;
+}
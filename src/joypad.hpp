@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+
+#include "memoryrange.hpp"
+#include "mmu.hpp"
+#include "savestate.hpp"
+
+// Buttons as bits of the mask handed to Joypad::SetButtons, set if held
+enum JoypadButton : std::uint8_t
+{
+  RIGHT = 1U << 0U,
+  LEFT = 1U << 1U,
+  UP = 1U << 2U,
+  DOWN = 1U << 3U,
+  A = 1U << 4U,
+  B = 1U << 5U,
+  SELECT = 1U << 6U,
+  START = 1U << 7U,
+};
+
+// Joypad register: 0xFF00
+// https://gbdev.io/pandocs/Joypad_Input.html
+class Joypad : public MemoryRange
+{
+public:
+  explicit Joypad(MemoryManagementUnit &mmu);
+
+  // Set the buttons held from now on, a mask of JoypadButton
+  void SetButtons(std::uint8_t buttons);
+
+  [[nodiscard]]
+  bool Contains(std::uint16_t addr) const override;
+
+  [[nodiscard]]
+  std::uint8_t Read(std::uint16_t addr) const override;
+
+  void Write(std::uint16_t addr, std::uint8_t data) override;
+
+  std::uint8_t &Address(std::uint16_t addr) override;
+
+  void SaveState(SaveStateWriter &writer) const;
+  void LoadState(SaveStateReader &reader);
+
+private:
+  // Low nibble of the register, a bit is 0 if a button in a selected group is
+  // held
+  [[nodiscard]]
+  std::uint8_t InputLines() const;
+
+  // Request the joypad interrupt if any input line went from high to low
+  void UpdateInputLines();
+
+  struct State
+  {
+    // bits 4 and 5 of the register, a group of buttons is selected when its
+    // bit is 0
+    std::uint8_t select{0x30};
+    std::uint8_t buttons{};
+    std::uint8_t inputLines{0x0F};
+  };
+
+  MemoryManagementUnit &_mmu;
+  State _state;
+  // copy of the register handed out by Address, writes through it are lost
+  std::uint8_t _register{0xFF};
+};
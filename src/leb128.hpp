@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+// Variable length unsigned integers, 7 bits per byte with the high bit set on
+// every byte but the last. Small values, like most lengths, take one byte
+namespace Leb128
+{
+inline void Write(std::vector<std::uint8_t> &out, std::uint64_t value)
+{
+  while (value >= 0x80U)
+  {
+    out.push_back(static_cast<std::uint8_t>((value & 0x7FU) | 0x80U));
+    value >>= 7U;
+  }
+  out.push_back(static_cast<std::uint8_t>(value));
+}
+
+// Read the value at pos and move pos past it
+inline std::uint64_t Read(std::span<const std::uint8_t> in, std::size_t &pos)
+{
+  std::uint64_t value{};
+  unsigned int shift{};
+  std::uint8_t byte{};
+  do
+  {
+    if (pos >= in.size() || shift >= 64)
+    {
+      throw std::runtime_error("Malformed variable length integer");
+    }
+    byte = in[pos++];
+    value |= static_cast<std::uint64_t>(byte & 0x7FU) << shift;
+    shift += 7;
+  } while ((byte & 0x80U) != 0);
+  return value;
+}
+}  // namespace Leb128
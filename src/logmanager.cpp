@@ -6,6 +6,7 @@
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/spdlog.h>
 
+#include <mutex>
 #include <vector>
 
 namespace LogManager
@@ -56,6 +57,11 @@ void InitLogging(const std::string &level_str, const std::string &log_file)
 
 std::shared_ptr<spdlog::logger> GetLogger(const std::string &name)
 {
+  // machines are built on several threads at once by the batch runner, the
+  // lookup and the registration must not interleave
+  static std::mutex mutex;
+  std::lock_guard lock{mutex};
+
   // Return existing logger if already registered
   auto existing = spdlog::get(name);
   if (existing) return existing;
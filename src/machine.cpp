@@ -0,0 +1,198 @@
+#include "machine.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <format>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include "savestate.hpp"
+
+Machine::Machine(const std::string &bootRomPath, const std::string &romPath,
+    Display &display, Ppu::RenderMode renderMode)
+    : Machine(RomImage::Open(bootRomPath), RomImage::Open(romPath), display,
+          renderMode)
+{
+}
+
+Machine::Machine(std::shared_ptr<const RomImage> bootRom,
+    std::shared_ptr<const RomImage> rom, Display &display,
+    Ppu::RenderMode renderMode)
+    : _cpu(_mmu), _idleLoop(_mmu)
+{
+  // load the bootrom, it's registered first so it shadows the game rom
+  // until it disables itself
+  _bootRom = std::make_shared<BootRom>();
+  _bootRom->Load(std::move(bootRom));
+  _mmu.AddMemoryRange(_bootRom);
+
+  // add cartridge: rom 0x0000 - 0x7FFF and external ram 0xA000 - 0xBFFF
+  _cartridge = std::make_shared<Cartridge>(_mmu, _scheduler, std::move(rom));
+  _mmu.AddMemoryRange(_cartridge);
+  _cartridge->MapBanks();
+  // add work ram 1: 0xC000 - 0xCFFF
+  _workRam0 = std::make_shared<ConcreteMemoryRange>(0x1000, 0xC000);
+  _mmu.AddMemoryRange(_workRam0);
+  // add work ram 1: 0xD000 - 0xDFFF
+  _workRam1 = std::make_shared<ConcreteMemoryRange>(0x1000, 0xD000);
+  _mmu.AddMemoryRange(_workRam1);
+
+  // add vram: 0x8000 - 0x9FFF
+  _vram = std::make_shared<VideoRam>();
+  _mmu.AddMemoryRange(_vram);
+  // add hram: 0xFF80 - 0xFFFE
+  constexpr int HRAM_SIZE{0x7F};
+  constexpr int HRAM_START_ADDRESS{0xFF80};
+  _hram = std::make_shared<ConcreteMemoryRange>(HRAM_SIZE, HRAM_START_ADDRESS);
+  _mmu.AddMemoryRange(_hram);
+  // add ppu: 0xFF44
+  _ppu = std::make_shared<Ppu>(_mmu, *_vram, display, _scheduler, renderMode);
+  _mmu.AddMemoryRange(_ppu);
+
+  // add oam, shadowed by the oam inside the ppu
+  _mmu.AddMemoryRange(std::make_shared<ConcreteMemoryRange>(0xA0, 0xFE00));
+
+  _timer = std::make_shared<Timer>(_mmu, _scheduler);
+  _mmu.AddMemoryRange(_timer);
+
+  // add joypad: 0xFF00
+  _joypad = std::make_shared<Joypad>(_mmu);
+  _mmu.AddMemoryRange(_joypad);
+
+  // add oam dma: 0xFF46
+  _dma = std::make_shared<Dma>(_mmu, *_ppu, _scheduler);
+  _mmu.AddMemoryRange(_dma);
+}
+
+Machine::~Machine()
+{
+  // the clock is caught up against the scheduler, which is gone by the time
+  // the cartridge is destroyed
+  _cartridge->FlushSaveFile();
+}
+
+void Machine::RunFrame()
+{
+  auto frame = _ppu->FrameCount();
+  while (_ppu->FrameCount() == frame)
+  {
+    // run the cpu freely until the next scheduled event, timer and ppu
+    // catch up on their own when their registers are accessed
+    while (!_scheduler.IsEventDue())
+    {
+      if (_cpu.IsWaitingForInterrupt())
+      {
+        SkipHalt();
+        break;
+      }
+      _cpu.RunUntilInterruptCheck(_scheduler);
+      if (_cpu.TakeBackwardJump())
+      {
+        _idleLoop.OnBackwardJump(
+            _cpu.GetCpuState(), _cpu.BackwardJumpEnd(), _scheduler);
+      }
+    }
+    _scheduler.RunDueEvents();
+    _idleLoop.Reset();
+  }
+}
+
+void Machine::SkipHalt()
+{
+  // interrupts are only requested by events, so the cpu stays halted at least
+  // until the next one. Jump there at once, rounded up to the steps the
+  // halted cpu takes, so it wakes up on the same cycle as when ticked
+  if (!_scheduler.HasPendingEvent())
+  {
+    // nothing to wait for, the cpu just takes its halted step
+    _scheduler.Advance(Cpu::HALTED_TICK_CYCLES);
+    return;
+  }
+  auto cycles = _scheduler.NextEventTime() - _scheduler.Now();
+  constexpr auto step{static_cast<std::uint64_t>(Cpu::HALTED_TICK_CYCLES)};
+  // far off events are reached in several jumps of whole steps
+  constexpr auto maxSkip{std::numeric_limits<int>::max() / step * step};
+  auto skip = std::min((cycles + step - 1) / step * step, maxSkip);
+  _scheduler.Advance(static_cast<int>(skip));
+}
+
+std::uint64_t Machine::FrameCount() const
+{
+  return _ppu->FrameCount();
+}
+
+void Machine::SetButtons(std::uint8_t buttons)
+{
+  _joypad->SetButtons(buttons);
+}
+
+bool Machine::UseSaveFile(const std::string &filePath)
+{
+  return _cartridge->UseSaveFile(filePath);
+}
+
+void Machine::FlushSaveFile() const
+{
+  _cartridge->FlushSaveFile();
+}
+
+void Machine::SaveState(std::vector<std::uint8_t> &buffer) const
+{
+  buffer.clear();
+  SaveStateWriter writer{buffer};
+  writer.Write(SaveStateHeader{
+      .magic = SAVE_STATE_MAGIC, .version = SAVE_STATE_VERSION, .size = 0});
+  // ppu goes first, it checks the render mode before anything is loaded
+  _ppu->SaveState(writer);
+  _cpu.SaveState(writer);
+  _scheduler.SaveState(writer);
+  _timer->SaveState(writer);
+  _joypad->SaveState(writer);
+  _dma->SaveState(writer);
+  _bootRom->SaveState(writer);
+  _vram->SaveState(writer);
+  _cartridge->SaveState(writer);
+  _workRam0->SaveState(writer);
+  _workRam1->SaveState(writer);
+  _hram->SaveState(writer);
+
+  auto size = static_cast<std::uint64_t>(buffer.size());
+  std::memcpy(
+      buffer.data() + offsetof(SaveStateHeader, size), &size, sizeof(size));
+}
+
+void Machine::LoadState(std::span<const std::uint8_t> buffer)
+{
+  SaveStateReader reader{buffer};
+  SaveStateHeader header{};
+  reader.Read(header);
+  if (header.magic != SAVE_STATE_MAGIC)
+  {
+    throw std::runtime_error("Not a save state");
+  }
+  if (header.version != SAVE_STATE_VERSION)
+  {
+    throw std::runtime_error(
+        std::format("Unsupported save state version: {}", header.version));
+  }
+  if (header.size != buffer.size())
+  {
+    throw std::runtime_error("Save state is truncated");
+  }
+
+  _ppu->LoadState(reader);
+  _cpu.LoadState(reader);
+  _scheduler.LoadState(reader);
+  _timer->LoadState(reader);
+  _joypad->LoadState(reader);
+  _dma->LoadState(reader);
+  _bootRom->LoadState(reader);
+  _vram->LoadState(reader);
+  _cartridge->LoadState(reader);
+  _workRam0->LoadState(reader);
+  _workRam1->LoadState(reader);
+  _hram->LoadState(reader);
+  _idleLoop.Reset();
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "bootrom.hpp"
+#include "cartridge.hpp"
+#include "concretememoryrange.hpp"
+#include "cpu.hpp"
+#include "display.hpp"
+#include "dma.hpp"
+#include "idleloopdetector.hpp"
+#include "joypad.hpp"
+#include "mmu.hpp"
+#include "ppu.hpp"
+#include "romimage.hpp"
+#include "scheduler.hpp"
+#include "timer.hpp"
+#include "videoram.hpp"
+
+// A whole gameboy: owns every component and builds the memory map connecting
+// them. Frontends only provide a display and drive it frame by frame
+class Machine
+{
+public:
+  Machine(const std::string &bootRomPath, const std::string &romPath,
+      Display &display, Ppu::RenderMode renderMode);
+  // Machines built from the same images share the rom, nothing writes to it
+  Machine(std::shared_ptr<const RomImage> bootRom,
+      std::shared_ptr<const RomImage> rom, Display &display,
+      Ppu::RenderMode renderMode);
+
+  // components keep references to each other, so a machine can't be moved
+  Machine(const Machine &) = delete;
+  Machine &operator=(const Machine &) = delete;
+  Machine(Machine &&) = delete;
+  Machine &operator=(Machine &&) = delete;
+  // stores the cartridge clock, see FlushSaveFile
+  ~Machine();
+
+  // Run until the ppu completes the next frame, i.e the start of vblank
+  void RunFrame();
+
+  [[nodiscard]]
+  std::uint64_t FrameCount() const;
+
+  // Buttons held from now on, a mask of JoypadButton. Frontends set them once
+  // per frame so a run can be replayed from the frames they changed at
+  void SetButtons(std::uint8_t buttons);
+
+  // Keep battery backed cartridge ram in the save file at filePath, loading
+  // it from there if the file exists. Call before running, returns false if
+  // the cartridge has no battery backed ram
+  bool UseSaveFile(const std::string &filePath);
+
+  // Start writing changed cartridge ram and the clock to the save file,
+  // without waiting. Frontends call it every now and then, the machine
+  // flushes on destruction
+  void FlushSaveFile() const;
+
+  // Snapshot the whole machine into buffer, its capacity is reused so saving
+  // into the same buffer again doesn't allocate. Roms are not part of the
+  // state, it must be loaded into a machine running the same game
+  void SaveState(std::vector<std::uint8_t> &buffer) const;
+
+  // Restore a snapshot made by SaveState, throws std::runtime_error without
+  // touching the machine if it isn't a compatible save state
+  void LoadState(std::span<const std::uint8_t> buffer);
+
+private:
+  // Advance a halted cpu waiting for an interrupt to the next event
+  void SkipHalt();
+
+  MemoryManagementUnit _mmu;
+  Scheduler _scheduler;
+  std::shared_ptr<BootRom> _bootRom;
+  std::shared_ptr<Cartridge> _cartridge;
+  std::shared_ptr<ConcreteMemoryRange> _workRam0;
+  std::shared_ptr<ConcreteMemoryRange> _workRam1;
+  std::shared_ptr<ConcreteMemoryRange> _hram;
+  std::shared_ptr<VideoRam> _vram;
+  std::shared_ptr<Ppu> _ppu;
+  std::shared_ptr<Timer> _timer;
+  std::shared_ptr<Joypad> _joypad;
+  std::shared_ptr<Dma> _dma;
+  Cpu _cpu;
+  IdleLoopDetector _idleLoop;
+};
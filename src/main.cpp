@@ -1,93 +1,219 @@
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
 #include <exception>
-#include <memory>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include "SDL3/SDL_events.h"
-#include "bootrom.hpp"
-#include "concretememoryrange.hpp"
-#include "cpu.hpp"
-#include "filememoryrange.hpp"
+#include "framepacer.hpp"
 #include "logmanager.hpp"
-#include "mmu.hpp"
+#include "joypad.hpp"
+#include "machine.hpp"
+#include "movie.hpp"
 #include "ppu.hpp"
+#include "rewindbuffer.hpp"
 #include "sdldisplay.hpp"
-#include "timer.hpp"
+
+namespace
+{
+// Joypad button mapped to key, 0 if the key isn't mapped
+std::uint8_t ButtonForKey(SDL_Keycode key)
+{
+  switch (key)
+  {
+    case SDLK_RIGHT:
+      return JoypadButton::RIGHT;
+    case SDLK_LEFT:
+      return JoypadButton::LEFT;
+    case SDLK_UP:
+      return JoypadButton::UP;
+    case SDLK_DOWN:
+      return JoypadButton::DOWN;
+    case SDLK_X:
+      return JoypadButton::A;
+    case SDLK_Z:
+      return JoypadButton::B;
+    case SDLK_BACKSPACE:
+      return JoypadButton::SELECT;
+    case SDLK_RETURN:
+      return JoypadButton::START;
+    default:
+      return 0;
+  }
+}
+}  // namespace
 
 int main(int argc, char **argv)
 {
   LogManager::InitLogging(GB_LOG_LEVEL, "log.txt");
   auto logger = LogManager::GetLogger("main");
   // early exit if no rom present
-  if (argc != 3)
+  if (argc < 3)
   {
     LOG_CRITICAL(logger, "No rom paths provided\n");
     return 1;
   }
 
-  MemoryManagementUnit mmu;
-
-  // load the bootrom and add it to romPath
-  char *bootRomPath = argv[1];  // rom filepath
-  auto bootRom = std::make_shared<BootRom>();
-  bootRom->Load(bootRomPath);
-  mmu.AddMemoryRange(bootRom);
-
-  // load the game rom
-  char *romPath = argv[2];  // rom filepath
-  auto rom = std::make_shared<FileMemoryRange>();
-  rom->Load(romPath, 0x0);
-  mmu.AddMemoryRange(rom);
-
-  // TODO: external ram comes from catridge, so we should not need to explicitly
-  // register the external ram here
-  //       This will probably be handled by Mappers for catridge when I
-  //       implement one
-  // add external ram: 0xA000 - 0xBFFF
-  mmu.AddMemoryRange(std::make_shared<ConcreteMemoryRange>(0x2000, 0xA000));
-  // add work ram 1: 0xC000 - 0xCFFF
-  mmu.AddMemoryRange(std::make_shared<ConcreteMemoryRange>(0x1000, 0xC000));
-  // add work ram 1: 0xD000 - 0xDFFF
-  mmu.AddMemoryRange(std::make_shared<ConcreteMemoryRange>(0x1000, 0xD000));
+  // --scanline renders whole lines at the start of hblank instead of running
+  // the pixel fifo every dot
+  // --speed N runs at N times the gameboy's speed, 0 runs uncapped
+  // --record FILE saves the input as a movie on exit
+  // --replay FILE plays the input of a movie instead of the keyboard's
+  // battery backed cartridge ram is kept in the rom's .sav file, except for
+  // movies which always start from blank ram
+  auto renderMode = Ppu::RenderMode::Dot;
+  double speed{1.0};
+  std::string recordPath;
+  std::string replayPath;
+  for (int i{3}; i < argc; ++i)
+  {
+    std::string_view arg{argv[i]};
+    if (arg == "--scanline")
+    {
+      renderMode = Ppu::RenderMode::Scanline;
+    }
+    else if (arg == "--speed" && i + 1 < argc)
+    {
+      std::string_view value{argv[++i]};
+      auto [ptr, ec] =
+          std::from_chars(value.data(), value.data() + value.size(), speed);
+      if (ec != std::errc{} || ptr != value.data() + value.size() || speed < 0)
+      {
+        LOG_CRITICAL(logger, "Invalid speed: {}\n", value);
+        return 1;
+      }
+    }
+    else if (arg == "--record" && i + 1 < argc)
+    {
+      recordPath = argv[++i];
+    }
+    else if (arg == "--replay" && i + 1 < argc)
+    {
+      replayPath = argv[++i];
+    }
+    else
+    {
+      LOG_WARN(logger, "Ignoring unknown option: {}\n", arg);
+    }
+  }
 
-  // add vram: 0x8000 - 0x9FFF
-  constexpr int VRAM_SIZE{1024 * 8};
-  constexpr int VRAM_START_ADDRESS{0x8000};
-  mmu.AddMemoryRange(
-      std::make_shared<ConcreteMemoryRange>(VRAM_SIZE, VRAM_START_ADDRESS));
-  // add hram: 0xFF80 - 0xFFFE
-  constexpr int HRAM_SIZE{0x7F};
-  constexpr int HRAM_START_ADDRESS{0xFF80};
-  mmu.AddMemoryRange(
-      std::make_shared<ConcreteMemoryRange>(HRAM_SIZE, HRAM_START_ADDRESS));
-  // add ppu: 0xFF44
   SdlDisplay display{"NoobBoy"};
-  std::shared_ptr<Ppu> ppu{std::make_shared<Ppu>(mmu, display)};
-  mmu.AddMemoryRange(ppu);
-
-  // add oam
-  mmu.AddMemoryRange(std::make_shared<ConcreteMemoryRange>(0xA0, 0xFE00));
-
-  auto timer = std::make_shared<Timer>(mmu);
-  mmu.AddMemoryRange(timer);
-
-  Cpu cpu(mmu);
+  // argv[1] is the bootrom, argv[2] the game rom
+  Machine machine{argv[1], argv[2], display, renderMode};
+  FramePacer pacer{speed};
+  // F5 saves the machine here, F8 goes back to it
+  std::vector<std::uint8_t> quickSave;
+  // holding R rewinds through the last few minutes
+  constexpr std::size_t REWIND_CAPACITY{8 * 1024 * 1024};
+  constexpr unsigned int REWIND_INTERVAL{4};
+  RewindBuffer rewindBuffer{REWIND_CAPACITY, REWIND_INTERVAL};
+  // cartridge ram changes reach the disk about once a second
+  constexpr std::uint64_t SAVE_FLUSH_INTERVAL{60};
+  bool rewinding{false};
+  // buttons held on the keyboard
+  std::uint8_t buttons{};
 
   // game loop
   try
   {
+    if (recordPath.empty() && replayPath.empty())
+    {
+      auto savePath = std::filesystem::path{argv[2]}.replace_extension(".sav");
+      machine.UseSaveFile(savePath.string());
+    }
+    Movie replay;
+    if (!replayPath.empty())
+    {
+      replay = Movie::Load(replayPath);
+    }
+    Movie recording;
     SDL_Event event;
     bool quit{false};
     while (!quit)
     {
+      // input is polled once per frame, at the start of vblank
       while (SDL_PollEvent(&event))
       {
         if (event.type == SDL_EVENT_QUIT)
         {
           quit = true;
         }
+        else if (event.type == SDL_EVENT_KEY_DOWN && !event.key.repeat)
+        {
+          if (event.key.key == SDLK_TAB)
+          {
+            // tab toggles between the chosen speed and uncapped
+            pacer.SetSpeed(pacer.GetSpeed() > 0 ? 0 : speed);
+          }
+          else if (event.key.key == SDLK_F5)
+          {
+            machine.SaveState(quickSave);
+            LOG_INFO(logger, "Saved state\n");
+          }
+          else if (event.key.key == SDLK_F8 && !quickSave.empty())
+          {
+            machine.LoadState(quickSave);
+            LOG_INFO(logger, "Loaded state\n");
+          }
+          else if (event.key.key == SDLK_R)
+          {
+            rewinding = true;
+          }
+          else
+          {
+            buttons |= ButtonForKey(event.key.key);
+          }
+        }
+        else if (event.type == SDL_EVENT_KEY_UP)
+        {
+          if (event.key.key == SDLK_R)
+          {
+            rewinding = false;
+          }
+          buttons = static_cast<std::uint8_t>(
+              buttons & ~ButtonForKey(event.key.key));
+        }
+      }
+
+      bool runFrame{true};
+      if (rewinding)
+      {
+        // show one frame from each snapshot going back, the game stays on
+        // the oldest one once the history runs out
+        runFrame = rewindBuffer.Rewind(machine);
+      }
+      if (runFrame)
+      {
+        // movies are keyed by frame, after going back they play or record
+        // from the frame the machine went back to
+        auto frame = machine.FrameCount();
+        auto held = replayPath.empty() ? buttons : replay.ButtonsAt(frame);
+        if (!recordPath.empty())
+        {
+          recording.Record(frame, held);
+        }
+        machine.SetButtons(held);
+        machine.RunFrame();
+        if (!rewinding)
+        {
+          rewindBuffer.OnFrame(machine);
+        }
+        if (machine.FrameCount() % SAVE_FLUSH_INTERVAL == 0)
+        {
+          machine.FlushSaveFile();
+        }
       }
-      int cycles = cpu.Tick();
-      timer->Tick(cycles);
-      ppu->Tick(cycles);
+      pacer.WaitForNextFrame();
+    }
+
+    if (!recordPath.empty())
+    {
+      recording.Save(recordPath);
+      LOG_INFO(logger, "Saved movie of {} frames to {}\n",
+          recording.FrameCount(), recordPath);
     }
   }
   catch (std::exception &ex)
@@ -0,0 +1,47 @@
+#include "memorydisplay.hpp"
+
+#include <algorithm>
+
+MemoryDisplay::MemoryDisplay(bool hashFrames) : _hashFrames(hashFrames)
+{
+}
+
+void MemoryDisplay::DrawLine(
+    unsigned int ly, std::span<const std::uint8_t, SCREEN_WIDTH> shades)
+{
+  if (ly >= LCD_HEIGHT)
+  {
+    return;
+  }
+  std::ranges::copy(shades, _framebuffer.begin() + (ly * SCREEN_WIDTH));
+}
+
+void MemoryDisplay::UpdateFrame()
+{
+  if (_hashFrames)
+  {
+    _frameHash = HashFramebuffer();
+  }
+}
+
+std::uint64_t MemoryDisplay::HashFramebuffer() const
+{
+  constexpr std::uint64_t FNV_OFFSET_BASIS{0xcbf29ce484222325ULL};
+  constexpr std::uint64_t FNV_PRIME{0x100000001b3ULL};
+  auto hash = FNV_OFFSET_BASIS;
+  for (auto shade : _framebuffer)
+  {
+    hash = (hash ^ shade) * FNV_PRIME;
+  }
+  return hash;
+}
+
+std::span<const std::uint8_t> MemoryDisplay::GetFramebuffer() const
+{
+  return _framebuffer;
+}
+
+std::uint64_t MemoryDisplay::GetFrameHash() const
+{
+  return _frameHash;
+}
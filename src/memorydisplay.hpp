@@ -0,0 +1,42 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+
+#include "display.hpp"
+
+// Display that keeps the frame in memory, for headless runs that still need
+// the picture (tests, bots). Optionally hashes every completed frame so runs
+// can be compared without storing frames
+class MemoryDisplay : public Display
+{
+public:
+  constexpr static unsigned int LCD_HEIGHT{144};
+
+public:
+  explicit MemoryDisplay(bool hashFrames);
+
+  void DrawLine(unsigned int ly,
+      std::span<const std::uint8_t, SCREEN_WIDTH> shades) override;
+
+  void UpdateFrame() override;
+
+  // Shades of the frame, row by row. Complete right after a frame ends
+  [[nodiscard]]
+  std::span<const std::uint8_t> GetFramebuffer() const;
+
+  // FNV-1a hash of the last completed frame, 0 if hashing is disabled
+  [[nodiscard]]
+  std::uint64_t GetFrameHash() const;
+
+  // FNV-1a hash of the framebuffer as it is now, the same as GetFrameHash
+  // right after a frame ends
+  [[nodiscard]]
+  std::uint64_t HashFramebuffer() const;
+
+private:
+  std::array<std::uint8_t, SCREEN_WIDTH * LCD_HEIGHT> _framebuffer{};
+  bool _hashFrames;
+  std::uint64_t _frameHash{};
+};
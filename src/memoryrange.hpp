@@ -1,10 +1,22 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 
 // Interface for a memory area in gameboy memory map
 struct MemoryRange
 {
+  // Host memory backing a memory range, lets the mmu access plain memory
+  // without going through the virtual Read/Write calls
+  struct Storage
+  {
+    std::uint8_t *data{};
+    std::size_t offset{};
+    std::size_t size{};
+    // false if writes must still go through Write (e.g rom)
+    bool writable{};
+  };
+
   MemoryRange(const MemoryRange &) = default;
   MemoryRange &operator=(const MemoryRange &) = default;
   MemoryRange(MemoryRange &&) = default;
@@ -18,4 +30,12 @@ struct MemoryRange
   virtual std::uint8_t Read(std::uint16_t addr) const = 0;
   virtual void Write(std::uint16_t addr, std::uint8_t data) = 0;
   virtual std::uint8_t &Address(std::uint16_t addr) = 0;
+
+  // Ranges that are plain memory return their backing storage here, ranges
+  // that need to intercept reads or writes must return an empty storage
+  [[nodiscard]]
+  virtual Storage GetStorage()
+  {
+    return {};
+  }
 };
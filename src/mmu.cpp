@@ -9,32 +9,109 @@ MemoryManagementUnit::MemoryManagementUnit()
   _logger = LogManager::GetLogger("Mmu");
 }
 
-auto MemoryManagementUnit::GetMemoryRange(std::uint16_t addr) const
+MemoryRange *MemoryManagementUnit::GetMemoryRange(std::uint16_t addr) const
 {
-  return std::find_if(_memoryRanges.cbegin(), _memoryRanges.cend(),
-      [=](const auto &range) { return range->Contains(addr); });
+  // only ranges registered for this page need to be checked, first registered
+  // range that contains the address wins
+  for (auto *range : _pageRanges[addr >> 8U])
+  {
+    if (range->Contains(addr))
+    {
+      return range;
+    }
+  }
+  return nullptr;
 }
 
-auto MemoryManagementUnit::GetMemoryRange(std::uint16_t addr)
+void MemoryManagementUnit::UpdatePage(std::size_t page)
 {
-  return std::find_if(_memoryRanges.begin(), _memoryRanges.end(),
-      [=](const auto &range) { return range->Contains(addr); });
+  if (page == HIGH_RAM_START_ADDRESS / PAGE_SIZE)
+  {
+    UpdateHighRam();
+  }
+  SetPageMemory(page, nullptr, nullptr);
+  // map page directly to host memory only if it's owned by a single range
+  if (_pageRanges[page].size() != 1)
+  {
+    return;
+  }
+  auto *range = _pageRanges[page].front();
+  auto storage = range->GetStorage();
+  auto pageStart = page * PAGE_SIZE;
+  if (storage.data == nullptr || pageStart < storage.offset
+      || pageStart + PAGE_SIZE > storage.offset + storage.size)
+  {
+    return;
+  }
+  for (std::size_t addr{pageStart}; addr < pageStart + PAGE_SIZE; ++addr)
+  {
+    if (!range->Contains(static_cast<std::uint16_t>(addr)))
+    {
+      return;
+    }
+  }
+  auto *memory = storage.data + (pageStart - storage.offset);
+  SetPageMemory(page, memory, storage.writable ? memory : nullptr);
+}
+
+void MemoryManagementUnit::UpdateHighRam()
+{
+  _highRam = nullptr;
+  auto *range = GetMemoryRange(HIGH_RAM_START_ADDRESS);
+  if (range == nullptr)
+  {
+    return;
+  }
+  auto storage = range->GetStorage();
+  if (storage.data == nullptr || !storage.writable
+      || HIGH_RAM_START_ADDRESS < storage.offset
+      || HIGH_RAM_START_ADDRESS + HIGH_RAM_SIZE
+             > storage.offset + storage.size)
+  {
+    return;
+  }
+  // the range has to be the one every hram address goes to
+  for (std::uint16_t addr{HIGH_RAM_START_ADDRESS};
+      addr < HIGH_RAM_START_ADDRESS + HIGH_RAM_SIZE; ++addr)
+  {
+    if (GetMemoryRange(addr) != range)
+    {
+      return;
+    }
+  }
+  _highRam = storage.data + (HIGH_RAM_START_ADDRESS - storage.offset);
+}
+
+void MemoryManagementUnit::SetPageMemory(
+    std::size_t page, const std::uint8_t *read, std::uint8_t *write)
+{
+  _mappedPageReadMemory[page] = read;
+  _mappedPageWriteMemory[page] = write;
+  if (!_lockedPages[page])
+  {
+    _pageReadMemory[page] = read;
+    _pageWriteMemory[page] = write;
+  }
 }
 
 bool MemoryManagementUnit::Contains(
     std::uint16_t addr) const  // TODO: Do I need this
 {
-  auto memoryRange = GetMemoryRange(addr);
-  return memoryRange != _memoryRanges.cend();
+  return _pageReadMemory[addr >> 8U] != nullptr
+         || GetMemoryRange(addr) != nullptr;
 }
 
-std::uint8_t MemoryManagementUnit::Read(std::uint16_t addr) const
+std::uint8_t MemoryManagementUnit::ReadMemoryRange(std::uint16_t addr) const
 {
-  auto memoryRange = GetMemoryRange(addr);
+  if (_lockedPages[addr >> 8U])
+  {
+    return 0xFF;
+  }
+
   // If we found a memory range read from it
-  if (memoryRange != _memoryRanges.cend())
+  if (auto *memoryRange = GetMemoryRange(addr))
   {
-    return memoryRange->get()->Read(addr);
+    return memoryRange->Read(addr);
   }
 
   // return garbage value if no memory range found that contains addr
@@ -49,13 +126,18 @@ std::uint8_t MemoryManagementUnit::Read(std::uint16_t addr) const
   return 0xFF;
 }
 
-void MemoryManagementUnit::Write(std::uint16_t addr, std::uint8_t data)
+void MemoryManagementUnit::WriteMemoryRange(
+    std::uint16_t addr, std::uint8_t data)
 {
-  auto memoryRange = GetMemoryRange(addr);
+  if (_lockedPages[addr >> 8U])
+  {
+    return;
+  }
+
   // if memory region found write to it
-  if (memoryRange != _memoryRanges.end())
+  if (auto *memoryRange = GetMemoryRange(addr))
   {
-    memoryRange->get()->Write(addr, data);
+    memoryRange->Write(addr, data);
     return;
   }
   if (addr < 0xFEA0 || addr > 0xFEFF)
@@ -69,11 +151,22 @@ void MemoryManagementUnit::Write(std::uint16_t addr, std::uint8_t data)
 
 std::uint8_t &MemoryManagementUnit::Address(std::uint16_t addr)
 {
-  auto memoryRange = GetMemoryRange(addr);
+  // fast path, page is backed by writable plain memory
+  if (auto *memory = _pageWriteMemory[addr >> 8U])
+  {
+    return memory[addr & 0xFFU];
+  }
+
+  if (_lockedPages[addr >> 8U])
+  {
+    _unmapped = 0xFF;
+    return _unmapped;
+  }
+
   // If we found a memory range read from it
-  if (memoryRange != _memoryRanges.cend())
+  if (auto *memoryRange = GetMemoryRange(addr))
   {
-    return memoryRange->get()->Address(addr);
+    return memoryRange->Address(addr);
   }
 
   // return garbage value if no memory range found that contains addr
@@ -81,9 +174,8 @@ std::uint8_t &MemoryManagementUnit::Address(std::uint16_t addr)
       "Read: No registered memory region found that contains address: "
       "{:#06X}",
       addr);
-  static std::uint8_t dummy;
-  dummy = 0xFF;
-  return dummy;
+  _unmapped = 0xFF;
+  return _unmapped;
 }
 
 void MemoryManagementUnit::RequestInterrupt(uint8_t id)
@@ -95,5 +187,63 @@ void MemoryManagementUnit::RequestInterrupt(uint8_t id)
 void MemoryManagementUnit::AddMemoryRange(
     std::shared_ptr<MemoryRange> memoryRange)
 {
+  // register the range with every page it contains an address in, this is
+  // only done once so it's fine to probe every address
+  for (std::size_t page{0}; page < PAGE_COUNT; ++page)
+  {
+    auto pageStart = page * PAGE_SIZE;
+    for (std::size_t addr{pageStart}; addr < pageStart + PAGE_SIZE; ++addr)
+    {
+      if (memoryRange->Contains(static_cast<std::uint16_t>(addr)))
+      {
+        _pageRanges[page].push_back(memoryRange.get());
+        UpdatePage(page);
+        break;
+      }
+    }
+  }
   _memoryRanges.emplace_back(std::move(memoryRange));
 }
+
+void MemoryManagementUnit::MapPages(const MemoryRange &owner,
+    std::uint16_t start, std::size_t size, const std::uint8_t *read,
+    std::uint8_t *write)
+{
+  auto firstPage = std::size_t{start} / PAGE_SIZE;
+  for (std::size_t page{firstPage}; page < firstPage + size / PAGE_SIZE;
+      ++page)
+  {
+    if (_pageRanges[page].size() != 1 || _pageRanges[page].front() != &owner)
+    {
+      continue;
+    }
+    auto offset = (page - firstPage) * PAGE_SIZE;
+    SetPageMemory(page, read != nullptr ? read + offset : nullptr,
+        write != nullptr ? write + offset : nullptr);
+  }
+}
+
+void MemoryManagementUnit::LockPages(std::uint16_t start, std::size_t size)
+{
+  auto firstPage = std::size_t{start} / PAGE_SIZE;
+  for (std::size_t page{firstPage}; page < firstPage + size / PAGE_SIZE;
+      ++page)
+  {
+    _lockedPages[page] = true;
+    _pageReadMemory[page] = nullptr;
+    _pageWriteMemory[page] = nullptr;
+  }
+}
+
+void MemoryManagementUnit::UnlockPages()
+{
+  for (std::size_t page{0}; page < PAGE_COUNT; ++page)
+  {
+    if (_lockedPages[page])
+    {
+      _lockedPages[page] = false;
+      _pageReadMemory[page] = _mappedPageReadMemory[page];
+      _pageWriteMemory[page] = _mappedPageWriteMemory[page];
+    }
+  }
+}
@@ -2,6 +2,7 @@
 
 #include <spdlog/logger.h>
 
+#include <array>
 #include <cstdint>
 #include <memory>
 #include <vector>
@@ -9,33 +10,135 @@
 #include "memoryrange.hpp"
 class MemoryManagementUnit
 {
+public:
+  constexpr static std::size_t PAGE_SIZE{0x100};
+  constexpr static std::size_t PAGE_COUNT{0x100};
+  constexpr static std::uint16_t HIGH_RAM_START_ADDRESS{0xFF80};
+  constexpr static std::uint16_t HIGH_RAM_SIZE{0x7F};
+
 private:
   // utility
   [[nodiscard]]
-  auto GetMemoryRange(std::uint16_t addr) const;
+  MemoryRange *GetMemoryRange(std::uint16_t addr) const;
+
+  // Rebuild dispatch entry for a single page after memory ranges changed
+  void UpdatePage(std::size_t page);
+
+  // Rebuild the hram pointer after the ranges of its page changed
+  void UpdateHighRam();
+
+  // Set the host memory of page, it only takes effect once the page is
+  // unlocked
+  void SetPageMemory(
+      std::size_t page, const std::uint8_t *read, std::uint8_t *write);
+
+  // Offset of addr in hram, HIGH_RAM_SIZE or more if it's outside or hram
+  // isn't plain memory
+  [[nodiscard]]
+  unsigned int HighRamOffset(std::uint16_t addr) const
+  {
+    if (_highRam == nullptr)
+    {
+      return HIGH_RAM_SIZE;
+    }
+    // addresses below hram wrap around to offsets far past it
+    return static_cast<unsigned int>(addr) - HIGH_RAM_START_ADDRESS;
+  }
 
-  auto GetMemoryRange(std::uint16_t addr);
+  // slow path for pages that are not backed by plain memory
+  [[nodiscard]]
+  std::uint8_t ReadMemoryRange(std::uint16_t addr) const;
+
+  void WriteMemoryRange(std::uint16_t addr, std::uint8_t data);
 
 public:
   MemoryManagementUnit();
 
-  // TODO: try eliminate checking if a memory range is present in every method
-
   [[nodiscard]]
   bool Contains(std::uint16_t addr) const;  // TODO: Do I need this
 
+  // Read and Write are defined inline so plain memory accesses (opcode fetch,
+  // stack) don't leave the caller
   [[nodiscard]]
-  std::uint8_t Read(std::uint16_t addr) const;
+  std::uint8_t Read(std::uint16_t addr) const
+  {
+    if (const auto *memory = _pageReadMemory[addr >> 8U])
+    {
+      return memory[addr & 0xFFU];
+    }
+    if (auto offset = HighRamOffset(addr); offset < HIGH_RAM_SIZE)
+    {
+      return _highRam[offset];
+    }
+    return ReadMemoryRange(addr);
+  }
 
-  void Write(std::uint16_t addr, std::uint8_t data);
+  void Write(std::uint16_t addr, std::uint8_t data)
+  {
+    if (auto *memory = _pageWriteMemory[addr >> 8U])
+    {
+      memory[addr & 0xFFU] = data;
+      return;
+    }
+    if (auto offset = HighRamOffset(addr); offset < HIGH_RAM_SIZE)
+    {
+      _highRam[offset] = data;
+      return;
+    }
+    WriteMemoryRange(addr, data);
+  }
 
   std::uint8_t &Address(std::uint16_t addr);
 
+  // Host memory of the page containing addr, nullptr if the page isn't plain
+  // memory and has to be read through Read
+  [[nodiscard]]
+  const std::uint8_t *PageMemory(std::uint16_t addr) const
+  {
+    return _pageReadMemory[addr >> 8U];
+  }
+
   void RequestInterrupt(uint8_t id);
 
   void AddMemoryRange(std::shared_ptr<MemoryRange> memoryRange);
 
+  // Point the pages of [start, start + size) straight at host memory, for
+  // banked memory ranges whose storage moves (cartridge banks). read and
+  // write are the memory for start, nullptr sends accesses to the range
+  // instead. Only pages owned by owner alone are mapped, the others keep
+  // going through the memory ranges. Costs a store per page, no probing
+  void MapPages(const MemoryRange &owner, std::uint16_t start,
+      std::size_t size, const std::uint8_t *read, std::uint8_t *write);
+
+  // Cut the pages of [start, start + size) off the bus until UnlockPages,
+  // reads return 0xFF and writes are ignored (bus lockout of OAM DMA).
+  // Locking only clears the fast path pointers, so Read and Write stay as
+  // cheap as before
+  void LockPages(std::uint16_t start, std::size_t size);
+  void UnlockPages();
+
 private:
   std::vector<std::shared_ptr<MemoryRange>> _memoryRanges;
+  // Page dispatch table, every 256 byte page either points straight to host
+  // memory (if a single plain memory range covers the whole page) or has a
+  // list of memory ranges, in registration order, that contain some address
+  // in the page. Read only memory (rom) only gets a read pointer so writes
+  // still reach the memory range
+  std::array<const std::uint8_t *, PAGE_COUNT> _pageReadMemory{};
+  std::array<std::uint8_t *, PAGE_COUNT> _pageWriteMemory{};
+  std::array<std::vector<MemoryRange *>, PAGE_COUNT> _pageRanges{};
+  // Host memory of every page as mapped, the dispatch table above differs
+  // from it only for locked pages
+  std::array<const std::uint8_t *, PAGE_COUNT> _mappedPageReadMemory{};
+  std::array<std::uint8_t *, PAGE_COUNT> _mappedPageWriteMemory{};
+  std::array<bool, PAGE_COUNT> _lockedPages{};
+  // Host memory of hram. It shares its page with the io registers, so the
+  // page is never plain memory, but stack and hram variables are as hot as
+  // work ram. Set if one plain memory range holds all of hram, hram is never
+  // locked
+  std::uint8_t *_highRam{};
+  // handed out by Address when no memory range contains the address, it is
+  // per mmu so machines on different threads never write to the same byte
+  std::uint8_t _unmapped{0xFF};
   std::shared_ptr<spdlog::logger> _logger{};
 };
@@ -0,0 +1,123 @@
+#include "movie.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#include "leb128.hpp"
+
+namespace
+{
+struct MovieHeader
+{
+  std::array<char, 4> magic;
+  std::uint32_t version;
+  std::uint64_t frameCount;
+};
+}  // namespace
+
+void Movie::Record(std::uint64_t frame, std::uint8_t buttons)
+{
+  // a run that went back (rewind, loading a state) records over the frames
+  // it went back over
+  while (!_changes.empty() && _changes.back().frame >= frame)
+  {
+    _changes.pop_back();
+  }
+  _frameCount = frame + 1;
+  if (ButtonsAt(frame) == buttons)
+  {
+    return;
+  }
+  _changes.push_back({.frame = frame, .buttons = buttons});
+}
+
+std::uint8_t Movie::ButtonsAt(std::uint64_t frame) const
+{
+  if (frame >= _frameCount)
+  {
+    return 0;
+  }
+  // last change at or before frame
+  auto it = std::upper_bound(_changes.begin(), _changes.end(), frame,
+      [](std::uint64_t value, const Change &change) {
+        return value < change.frame;
+      });
+  return it == _changes.begin() ? 0 : std::prev(it)->buttons;
+}
+
+std::uint64_t Movie::FrameCount() const
+{
+  return _frameCount;
+}
+
+void Movie::Save(const std::string &filePath) const
+{
+  std::vector<std::uint8_t> data(sizeof(MovieHeader));
+  MovieHeader header{.magic = MOVIE_MAGIC,
+      .version = MOVIE_VERSION,
+      .frameCount = _frameCount};
+  std::memcpy(data.data(), &header, sizeof(header));
+  std::uint64_t previousFrame{};
+  for (const auto &change : _changes)
+  {
+    Leb128::Write(data, change.frame - previousFrame);
+    data.push_back(change.buttons);
+    previousFrame = change.frame;
+  }
+
+  std::ofstream file{filePath, std::ios::binary};
+  file.write(reinterpret_cast<const char *>(data.data()),
+      static_cast<std::streamsize>(data.size()));
+  if (!file)
+  {
+    throw std::runtime_error(
+        std::format("Failed to write movie: {}", filePath));
+  }
+}
+
+Movie Movie::Load(const std::string &filePath)
+{
+  std::ifstream file{filePath, std::ios::binary};
+  if (!file.is_open())
+  {
+    throw std::runtime_error(std::format("Failed to open movie: {}", filePath));
+  }
+  std::vector<std::uint8_t> data{std::istreambuf_iterator<char>{file},
+      std::istreambuf_iterator<char>{}};
+
+  MovieHeader header{};
+  if (data.size() < sizeof(header))
+  {
+    throw std::runtime_error("Movie is truncated");
+  }
+  std::memcpy(&header, data.data(), sizeof(header));
+  if (header.magic != MOVIE_MAGIC)
+  {
+    throw std::runtime_error(std::format("Not a movie: {}", filePath));
+  }
+  if (header.version != MOVIE_VERSION)
+  {
+    throw std::runtime_error(
+        std::format("Unsupported movie version: {}", header.version));
+  }
+
+  Movie movie;
+  movie._frameCount = header.frameCount;
+  std::span<const std::uint8_t> records{data};
+  std::size_t pos{sizeof(header)};
+  std::uint64_t frame{};
+  while (pos < records.size())
+  {
+    frame += Leb128::Read(records, pos);
+    if (pos >= records.size())
+    {
+      throw std::runtime_error("Movie is truncated");
+    }
+    movie._changes.push_back({.frame = frame, .buttons = records[pos++]});
+  }
+  return movie;
+}
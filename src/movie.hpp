@@ -0,0 +1,48 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Joypad input of a run, kept as the frames at which the held buttons
+// changed. A movie starts at power on, replaying it on a new machine with the
+// same roms reproduces the run exactly since input only changes between
+// frames.
+//
+// File format: MOVIE_MAGIC, MOVIE_VERSION and the frame count as a header,
+// then one record per change: the frames since the previous change as LEB128
+// followed by the buttons byte.
+class Movie
+{
+public:
+  constexpr static std::array<char, 4> MOVIE_MAGIC{'N', 'B', 'M', 'V'};
+  constexpr static std::uint32_t MOVIE_VERSION{1};
+
+  // Record the buttons held during frame, call it for every frame. Recording
+  // an earlier frame than the last one drops everything after it
+  void Record(std::uint64_t frame, std::uint8_t buttons);
+
+  // Buttons held during frame, nothing is held after the end of the movie
+  [[nodiscard]]
+  std::uint8_t ButtonsAt(std::uint64_t frame) const;
+
+  // Number of frames the movie covers
+  [[nodiscard]]
+  std::uint64_t FrameCount() const;
+
+  void Save(const std::string &filePath) const;
+
+  [[nodiscard]]
+  static Movie Load(const std::string &filePath);
+
+private:
+  struct Change
+  {
+    std::uint64_t frame;
+    std::uint8_t buttons;
+  };
+
+  std::vector<Change> _changes;
+  std::uint64_t _frameCount{};
+};
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+#include "display.hpp"
+
+// Display that throws frames away, for running without any output
+class NullDisplay : public Display
+{
+public:
+  void DrawLine([[maybe_unused]] unsigned int ly,
+      [[maybe_unused]] std::span<const std::uint8_t, SCREEN_WIDTH> shades)
+      override
+  {
+  }
+
+  void UpdateFrame() override
+  {
+  }
+};
@@ -0,0 +1,115 @@
+#include "oamram.hpp"
+
+#include <bit>
+#include <cstring>
+
+namespace
+{
+constexpr unsigned int SPRITE_Y_OFFSET{16};
+constexpr unsigned int SPRITE_Y_FLIP_FLAG{1U << 6U};
+}  // namespace
+
+OamRam::OamRam() : ConcreteMemoryRange(OAM_SIZE, OAM_START_ADDRESS)
+{
+}
+
+void OamRam::Write(std::uint16_t addr, std::uint8_t data)
+{
+  ConcreteMemoryRange::Write(addr, data);
+  _dirty = true;
+}
+
+std::uint8_t &OamRam::Address(std::uint16_t addr)
+{
+  _dirty = true;
+  return ConcreteMemoryRange::Address(addr);
+}
+
+MemoryRange::Storage OamRam::GetStorage()
+{
+  auto storage = ConcreteMemoryRange::GetStorage();
+  storage.writable = false;
+  return storage;
+}
+
+void OamRam::LoadState(SaveStateReader &reader)
+{
+  ConcreteMemoryRange::LoadState(reader);
+  _dirty = true;
+}
+
+void OamRam::WriteAll(std::span<const std::uint8_t, OAM_SIZE> data)
+{
+  std::memcpy(ConcreteMemoryRange::GetStorage().data, data.data(), data.size());
+  _dirty = true;
+}
+
+void OamRam::FindSprites(unsigned int ly, bool tallSprites, SpriteLine &line)
+{
+  line.count = 0;
+  if (ly >= SCREEN_HEIGHT)
+  {
+    return;
+  }
+  if (_dirty || tallSprites != _tallSprites)
+  {
+    BuildLineTable(tallSprites);
+  }
+
+  const auto *entries = ConcreteMemoryRange::GetStorage().data;
+  // lowest bit first is oam order
+  for (auto sprites = _lineSprites[ly];
+      sprites != 0 && line.count < MAX_SPRITES_PER_LINE; sprites &= sprites - 1)
+  {
+    auto index = static_cast<std::size_t>(std::countr_zero(sprites));
+    Sprite sprite{};
+    std::memcpy(&sprite, entries + (index * sizeof(Sprite)), sizeof(Sprite));
+
+    // insertion sort by x, a sprite goes after the ones with the same x
+    std::size_t pos{line.count};
+    while (pos > 0 && line.sprites[pos - 1].x > sprite.x)
+    {
+      line.sprites[pos] = line.sprites[pos - 1];
+      --pos;
+    }
+    line.sprites[pos] = sprite;
+    ++line.count;
+  }
+}
+
+std::uint16_t OamRam::GetTileRowAddress(
+    const Sprite &sprite, unsigned int ly, bool tallSprites)
+{
+  unsigned int height = tallSprites ? 16 : 8;
+  // masked in case the height changed since the sprite was found
+  auto row = (ly + SPRITE_Y_OFFSET - sprite.y) & (height - 1);
+  if ((sprite.flags & SPRITE_Y_FLIP_FLAG) != 0)
+  {
+    row = height - 1 - row;
+  }
+  // 8x16 sprites ignore bit 0 of the tile, the bottom half is the next tile
+  unsigned int tile = tallSprites ? (sprite.tile & 0xFEU) : sprite.tile;
+  return static_cast<std::uint16_t>(
+      BG_WIN_TILEDATA_ADDRESS1 + (tile * TILE_DATA_SIZE) + (row * 2));
+}
+
+void OamRam::BuildLineTable(bool tallSprites)
+{
+  _lineSprites.fill(0);
+  unsigned int height = tallSprites ? 16 : 8;
+  const auto *entries = ConcreteMemoryRange::GetStorage().data;
+  for (std::size_t index{0}; index < SPRITE_COUNT; ++index)
+  {
+    // y is the screen line + 16, sprites can start above the screen
+    unsigned int top = entries[index * sizeof(Sprite)];
+    for (unsigned int y{top}; y < top + height; ++y)
+    {
+      if (y >= SPRITE_Y_OFFSET && y - SPRITE_Y_OFFSET < SCREEN_HEIGHT)
+      {
+        _lineSprites[y - SPRITE_Y_OFFSET] |= std::uint64_t{1} << index;
+      }
+    }
+  }
+  _dirty = false;
+  _tallSprites = tallSprites;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "common.hpp"
+#include "concretememoryrange.hpp"
+
+// Object attribute memory: 0xFE00 - 0xFE9F, 40 sprites of 4 bytes. Keeps a
+// table of the sprites covering each line, so finding the sprites of a line
+// doesn't scan all of oam. The table is built again on the first lookup after
+// oam was written or the sprite height changed
+class OamRam : public ConcreteMemoryRange
+{
+public:
+  constexpr static std::size_t SPRITE_COUNT{40};
+  constexpr static std::size_t MAX_SPRITES_PER_LINE{10};
+
+  // One oam entry, in the byte order of oam
+  struct Sprite
+  {
+    std::uint8_t y;  // screen y + 16
+    std::uint8_t x;  // screen x + 8
+    std::uint8_t tile;
+    // bit 4: OBP1, bit 5: x flip, bit 6: y flip, bit 7: behind bg colors 1-3
+    std::uint8_t flags;
+  };
+
+  // Sprites drawn on a line, sorted by x and by oam index for equal x, so a
+  // sprite is drawn over the ones that come after it
+  struct SpriteLine
+  {
+    std::array<Sprite, MAX_SPRITES_PER_LINE> sprites;
+    std::uint8_t count;
+  };
+
+  OamRam();
+
+  void Write(std::uint16_t addr, std::uint8_t data) override;
+
+  // caller may write through the reference, so the table is invalidated
+  std::uint8_t &Address(std::uint16_t addr) override;
+
+  // Reads go straight to memory, writes must go through Write to invalidate
+  // the table
+  [[nodiscard]]
+  Storage GetStorage() override;
+
+  void LoadState(SaveStateReader &reader) override;
+
+  // Replace all of oam at once, for OAM DMA
+  void WriteAll(std::span<const std::uint8_t, OAM_SIZE> data);
+
+  // Sprites on line ly the way the oam scan picks them: the first 10 in oam
+  // order whose rows cover the line, tallSprites is LCDC bit 2
+  void FindSprites(unsigned int ly, bool tallSprites, SpriteLine &line);
+
+  // Address of the low byte of the row of sprite drawn on line ly, sprites
+  // always use the tile data at 0x8000
+  [[nodiscard]]
+  static std::uint16_t GetTileRowAddress(
+      const Sprite &sprite, unsigned int ly, bool tallSprites);
+
+private:
+  void BuildLineTable(bool tallSprites);
+
+  // bit i is set if sprite i covers the line
+  std::array<std::uint64_t, SCREEN_HEIGHT> _lineSprites{};
+  bool _dirty{true};
+  bool _tallSprites{};
+};
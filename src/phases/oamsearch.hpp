@@ -1,100 +1,68 @@
 #pragma once
 
-#include <array>
 #include <cstdint>
 
 #include "../bitutils.hpp"
 #include "../common.hpp"
 #include "../mmu.hpp"
+#include "../oamram.hpp"
+#include "../savestate.hpp"
 #include "ppuphase.hpp"
 
+// Picks the sprites of the line. The scan takes its 80 dots, but the sprites
+// come from the line table of oam at the end instead of reading all 40
+// entries through the mmu
 class OamSearch : public PpuPhase
 {
-private:
-  enum class OamSearchPhase : std::uint8_t
-  {
-    ReadingTileY,
-    ReadingTileX
-  };
-
-  struct OamEntryPosition
-  {
-    int x;
-    int y;
-    std::uint16_t address;
-  };
-
 public:
-  explicit OamSearch(MemoryManagementUnit &mmu)
-      : _mmu(mmu),
-        _phase{OamSearch::OamSearchPhase::ReadingTileY},
-        _tilesScanned(0),
-        _tileY(0),
-        _tileX(0),
-        _spritesOnCurrentLine{},
-        _nextSprite(0)
+  OamSearch(MemoryManagementUnit &mmu, OamRam &oam)
+      : _mmu(mmu), _oam(oam), _state{}
   {
   }
 
   void Start() override
   {
-    _phase = OamSearchPhase::ReadingTileY;
-    _tilesScanned = 0;
-    _tileY = 0;
-    _tileX = 0;
-    _spritesOnCurrentLine.fill({.x = -1, .y = -1, .address = 0});
-    _nextSprite = 0;
+    _state.dots = 0;
+    _state.sprites.count = 0;
   }
 
   bool Tick() override
   {
-    auto tileAddress = static_cast<std::uint16_t>(
-        OAM_START_ADDRESS + (OAM_ENTRY_SIZE * _tilesScanned));
-
-    switch (_phase)
+    ++_state.dots;
+    if (_state.dots < OAM_SEARCH_DOTS)
     {
-      case OamSearchPhase::ReadingTileY:
-      {
-        _tileY = _mmu.Read(tileAddress);
-        _phase = OamSearchPhase::ReadingTileX;
-        break;
-      }
-      case OamSearchPhase::ReadingTileX:
-      {
-        _tileX = _mmu.Read(static_cast<std::uint16_t>(tileAddress + 1));
-        int ly = _mmu.Read(LY_REGISTER_ADDRESS);
-        int objHeight =
-            BitUtils::Test<2>(_mmu.Read(LCDC_REGISTER_ADDRESS)) ? 16 : 8;
-        if ((_tileY <= (ly + 16)) && ((_tileY + objHeight) > (ly + 16)))
-        {
-          TryAddSpriteEntry(_tileX, _tileY, tileAddress);
-        }
-        _phase = OamSearchPhase::ReadingTileY;
-        ++_tilesScanned;
-        break;
-      }
+      return true;
     }
-    return _tilesScanned < 40;
+    _oam.FindSprites(_mmu.Read(LY_REGISTER_ADDRESS),
+        BitUtils::Test<2>(_mmu.Read(LCDC_REGISTER_ADDRESS)), _state.sprites);
+    return false;
   }
 
-private:
-  void TryAddSpriteEntry(int x, int y, std::uint16_t address)
+  // Sprites found by the last scan, for pixel rendering
+  [[nodiscard]]
+  const OamRam::SpriteLine &Sprites() const
   {
-    if (_nextSprite < 10)
-    {
-      _spritesOnCurrentLine[_nextSprite].x = x;
-      _spritesOnCurrentLine[_nextSprite].y = y;
-      _spritesOnCurrentLine[_nextSprite].address = address;
-    }
+    return _state.sprites;
   }
 
-  constexpr static std::uint16_t OAM_START_ADDRESS{0xFE00};
-  constexpr static int OAM_ENTRY_SIZE{4};  // in bytes
+  void SaveState(SaveStateWriter &writer) const
+  {
+    writer.Write(_state);
+  }
+
+  void LoadState(SaveStateReader &reader)
+  {
+    reader.Read(_state);
+  }
+
+private:
+  struct State
+  {
+    std::uint8_t dots{};
+    OamRam::SpriteLine sprites{};
+  };
+
   MemoryManagementUnit &_mmu;
-  OamSearchPhase _phase;
-  int _tilesScanned;
-  std::uint8_t _tileY;
-  std::uint8_t _tileX;
-  std::array<OamEntryPosition, 10> _spritesOnCurrentLine;
-  unsigned long _nextSprite;
+  OamRam &_oam;
+  State _state;
 };
@@ -1,89 +1,254 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+#include "../bitutils.hpp"
+#include "../color.hpp"
 #include "../display.hpp"
 #include "../fetcher.hpp"
+#include "../oamram.hpp"
+#include "../pixelfifo.hpp"
+#include "../savestate.hpp"
+#include "../videoram.hpp"
+#include "oamsearch.hpp"
 #include "ppuphase.hpp"
 
 class PixelRendering : public PpuPhase
 {
 public:
-  PixelRendering(MemoryManagementUnit &mmu, Display &display)
-      : _mmu(mmu), _display(display), _fetcher(mmu, _bgWinFifo)
+  // dots the pixel pipeline stands still for every sprite fetched
+  constexpr static unsigned int SPRITE_FETCH_DOTS{6};
+  // dots the pixel pipeline stands still for when the window starts
+  constexpr static unsigned int WINDOW_START_DOTS{6};
+  // window start of a line without window
+  constexpr static unsigned int NO_WINDOW{0xFF};
+
+  PixelRendering(MemoryManagementUnit &mmu, VideoRam &vram, Display &display,
+      const OamSearch &oamSearch)
+      : _mmu(mmu),
+        _vram(vram),
+        _display(display),
+        _oamSearch(oamSearch),
+        _fetcher(mmu, vram, _state.bgWinFifo)
+  {
+  }
+
+  // Window of the next line, decided by the ppu before the line starts.
+  // windowStart is the first screen x of the window or NO_WINDOW, the first
+  // windowDrop pixels of the window are left of the screen (WX < 7)
+  void SetWindow(unsigned int windowStart, unsigned int windowDrop,
+      unsigned int windowLine)
   {
+    _state.windowStart = windowStart;
+    _state.windowDrop = windowDrop;
+    _state.windowLine = windowLine;
   }
 
   void Start() override
   {
     _fetcher.Start();
+    _state.ly = _mmu.Read(LY_REGISTER_ADDRESS);
     auto scx = _mmu.Read(SCX_REGISTER_ADDRESS);
-    _pixelsDrawn = 0;
-    _pixelsToDrop =
+    _state.pixelsDrawn = 0;
+    _state.pixelsToDrop =
         8U + (scx & 0b111U);  // Initial tile that's fetched is dropped +
                               // (scroll register & 7) tiles are dropped
-    if (_pixelsToDrop > 8)
+    if (_state.pixelsToDrop > 8)
     {
       // TODO: add logging
     }
+    _state.spriteFifo.Clear();
+    _state.sprites = _oamSearch.Sprites();
+    _state.nextSprite = 0;
+    _state.stallDots = 0;
   }
 
   bool Tick() override
   {
+    // background fetcher and pixel output wait while a sprite is fetched or
+    // the window starts
+    if (_state.stallDots > 0)
+    {
+      --_state.stallDots;
+      return true;
+    }
+    if (FetchSprite())
+    {
+      _state.stallDots = SPRITE_FETCH_DOTS - 1;
+      return true;
+    }
     _fetcher.Tick();
     PushPixelToDisplay();
-    // _pixelsDrawn is incremented each time we successfully push out a pixel,
-    // if we reach _pixelsDrawn > 160 then we have already pushed out 160 pixels
+    // pixelsDrawn is incremented each time we successfully push out a pixel,
+    // if we reach pixelsDrawn > 160 then we have already pushed out 160 pixels
     // (width of the screen) and we cannot push any more pixels to the screen in
     // current scanline
-    return _pixelsDrawn < 160;
+    return _state.pixelsDrawn < 160;
+  }
+
+  // Number of pixels still to be pushed to the display on this line
+  [[nodiscard]]
+  unsigned int PixelsRemaining() const
+  {
+    return 160 - _state.pixelsDrawn;
+  }
+
+  void SaveState(SaveStateWriter &writer) const
+  {
+    writer.Write(_state);
+    _fetcher.SaveState(writer);
+  }
+
+  void LoadState(SaveStateReader &reader)
+  {
+    reader.Read(_state);
+    _fetcher.LoadState(reader);
   }
 
 private:
+  // Screen x of the first visible pixel of sprite, sprites at x < 8 are
+  // partly left of the screen
+  [[nodiscard]]
+  static unsigned int SpriteStart(const OamRam::Sprite &sprite)
+  {
+    return std::max<unsigned int>(sprite.x, 8U) - 8U;
+  }
+
+  // Fetch the next sprite if it starts at the pixel about to be pushed, its
+  // row is mixed into the sprite fifo at once. Returns true if a sprite was
+  // fetched
+  bool FetchSprite()
+  {
+    if (_state.nextSprite == _state.sprites.count || _state.pixelsToDrop > 0
+        || SpriteStart(_state.sprites.sprites[_state.nextSprite])
+               != _state.pixelsDrawn)
+    {
+      return false;
+    }
+
+    auto lcdc = _mmu.Read(LCDC_REGISTER_ADDRESS);
+    if (!BitUtils::Test<1>(lcdc))
+    {
+      // sprites are off, nothing is fetched for the ones at this pixel
+      while (_state.nextSprite < _state.sprites.count
+             && SpriteStart(_state.sprites.sprites[_state.nextSprite])
+                    == _state.pixelsDrawn)
+      {
+        ++_state.nextSprite;
+      }
+      return false;
+    }
+
+    const auto &sprite = _state.sprites.sprites[_state.nextSprite];
+    ++_state.nextSprite;
+    const auto *row = _vram.GetTileRow(OamRam::GetTileRowAddress(
+        sprite, _state.ly, BitUtils::Test<2>(lcdc)));
+    while (_state.spriteFifo.Size() < 8)
+    {
+      _state.spriteFifo.Push({.color = 0, .palette = 0, .bgPriority = 0});
+    }
+    auto xFlip = BitUtils::Test<5>(sprite.flags);
+    PixelFifo::Entry pixel{.color = 0,
+        .palette = BitUtils::Test<4>(sprite.flags),
+        .bgPriority = BitUtils::Test<7>(sprite.flags)};
+    // pixels left of the screen are skipped
+    auto skip = _state.pixelsDrawn + 8U - sprite.x;
+    for (unsigned int i{skip}; i < 8; ++i)
+    {
+      // a sprite only shows where the sprites fetched before it are
+      // transparent
+      auto &entry = _state.spriteFifo[i - skip];
+      if (entry.color == 0)
+      {
+        pixel.color = static_cast<std::uint8_t>(row[xFlip ? 7 - i : i] & 0x3U);
+        entry = pixel;
+      }
+    }
+    return true;
+  }
+
   void PushPixelToDisplay()
   {
-    if (_bgWinFifo.size() <= 0)
+    if (_state.bgWinFifo.Empty())
+    {
+      return;
+    }
+    // the window replaces the background from the pixel it starts at, this
+    // is checked once per pushed pixel and not on every fetch
+    if (_state.pixelsDrawn == _state.windowStart && _state.pixelsToDrop == 0)
     {
+      _state.windowStart = NO_WINDOW;
+      _fetcher.StartWindow(_state.windowLine);
+      for (unsigned int i{0}; i < _state.windowDrop; ++i)
+      {
+        _state.bgWinFifo.Pop();
+      }
+      _state.stallDots = WINDOW_START_DOTS - 1;
       return;
     }
-    Fetcher::PixelFifoEntry entry = _bgWinFifo.front();
-    _bgWinFifo.pop_front();
-    if (_pixelsToDrop > 0)
+    auto entry = _state.bgWinFifo.Pop();
+    if (_state.pixelsToDrop > 0)
     {
-      --_pixelsToDrop;
+      --_state.pixelsToDrop;
       return;
     }
 
-    if (_pixelsDrawn >= 160)
+    if (_state.pixelsDrawn >= 160)
     {
       return;
     }
 
-    Color color{};
-    switch (entry.color)
+    // background colors go through BGP
+    auto shade = PaletteShade(_mmu.Read(BGP_REGISTER_ADDRESS), entry.color);
+    if (!_state.spriteFifo.Empty())
+    {
+      // sprite color 0 is transparent, a sprite behind the background only
+      // shows over background color 0
+      auto sprite = _state.spriteFifo.Pop();
+      if (sprite.color != 0 && (sprite.bgPriority == 0 || entry.color == 0))
+      {
+        shade = PaletteShade(_mmu.Read(sprite.palette == 0
+                                           ? OBP0_REGISTER_ADDRESS
+                                           : OBP1_REGISTER_ADDRESS),
+            sprite.color);
+      }
+    }
+    _state.line[_state.pixelsDrawn] = shade;
+    ++_state.pixelsDrawn;  // Increment the number of pixels pushed to screen
+    if (_state.pixelsDrawn == SCREEN_WIDTH)
     {
-      case 0b00:
-        color = {.red = 0x34, .green = 0x3d, .blue = 0x37, .alpha = 0xff};
-        break;
-      case 0b01:
-        color = {.red = 0x55, .green = 0x64, .blue = 0x5a, .alpha = 0xff};
-        break;
-      case 0b10:
-        color = {.red = 0x8b, .green = 0xa3, .blue = 0x94, .alpha = 0xff};
-        break;
-      case 0b11:
-        color = {.red = 0xe0, .green = 0xf0, .blue = 0xe7, .alpha = 0xff};
-        break;
-      default:
-        break;
+      _display.DrawLine(_state.ly, _state.line);
     }
-    _display.Draw(Pixel(entry.x, entry.y, color));
-    ++_pixelsDrawn;  // Increment the number of pixels pushed to screen
   }
 
 private:
+  struct State
+  {
+    PixelFifo bgWinFifo;
+    PixelFifo spriteFifo;
+    unsigned int ly{};
+    unsigned int pixelsDrawn{};
+    unsigned int pixelsToDrop{};
+    // dots left of the sprite fetch or window start in progress
+    unsigned int stallDots{};
+    // set by SetWindow, windowStart becomes NO_WINDOW once the window started
+    unsigned int windowStart{NO_WINDOW};
+    unsigned int windowDrop{};
+    unsigned int windowLine{};
+    // sprites of the line, taken from oam search when the line starts
+    OamRam::SpriteLine sprites{};
+    std::uint8_t nextSprite{};
+    // shades of the line being rendered, handed to the display once complete
+    std::array<std::uint8_t, SCREEN_WIDTH> line{};
+  };
+
   MemoryManagementUnit &_mmu;
+  VideoRam &_vram;
   Display &_display;
+  const OamSearch &_oamSearch;
+  // declared before the fetcher, which keeps a reference to the fifo in it
+  State _state;
   Fetcher _fetcher;
-  std::deque<Fetcher::PixelFifoEntry> _bgWinFifo;
-  unsigned int _pixelsDrawn{};
-  unsigned int _pixelsToDrop{};
 };
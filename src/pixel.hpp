@@ -1,10 +0,0 @@
-#pragma once
-
-#include "color.hpp"
-
-struct Pixel
-{
-  unsigned int x;
-  unsigned int y;
-  Color color;
-};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Fixed capacity fifo of pixels waiting to be mixed and pushed to the lcd,
+// used for the background/window fifo and the sprite fifo. It never allocates
+// and fits in a single cache line
+class PixelFifo
+{
+public:
+  struct Entry
+  {
+    std::uint8_t color : 2;       // color id, before applying the palette
+    std::uint8_t palette : 1;     // sprites only: 0 = OBP0, 1 = OBP1
+    std::uint8_t bgPriority : 1;  // sprites only: 1 = behind bg colors 1-3
+  };
+
+  // fetcher only pushes 8 pixels when there are at most 8 left
+  constexpr static std::size_t CAPACITY{16};
+
+  [[nodiscard]]
+  std::size_t Size() const
+  {
+    return _size;
+  }
+
+  [[nodiscard]]
+  bool Empty() const
+  {
+    return _size == 0;
+  }
+
+  void Clear()
+  {
+    _head = 0;
+    _size = 0;
+  }
+
+  // Caller must make sure the fifo isn't full
+  void Push(Entry entry)
+  {
+    _entries[(_head + _size) % CAPACITY] = entry;
+    ++_size;
+  }
+
+  // Caller must make sure the fifo isn't empty
+  Entry Pop()
+  {
+    auto entry = _entries[_head];
+    _head = (_head + 1) % CAPACITY;
+    --_size;
+    return entry;
+  }
+
+  // i-th entry from the front, lets sprites be mixed into queued pixels
+  [[nodiscard]]
+  Entry &operator[](std::size_t i)
+  {
+    return _entries[(_head + i) % CAPACITY];
+  }
+
+private:
+  std::array<Entry, CAPACITY> _entries{};
+  std::size_t _head{};
+  std::size_t _size{};
+};
+
+static_assert(sizeof(PixelFifo::Entry) == 1, "PixelFifo::Entry must be packed");
+static_assert(sizeof(PixelFifo) <= 64, "PixelFifo must fit in a cache line");
@@ -1,165 +1,385 @@
 #include "ppu.hpp"
 
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+
 #include "bitutils.hpp"
 #include "common.hpp"
 #include "interrupt.hpp"
-#include "phases/hblank.hpp"
 #include "phases/oamsearch.hpp"
-#include "phases/vblank.hpp"
 
-Ppu::Ppu(MemoryManagementUnit &mmu, Display &display)
-    : _oamRam{OAM_SIZE, OAM_START_ADDRESS},
-      _ly(0),
+Ppu::Ppu(MemoryManagementUnit &mmu, VideoRam &vram, Display &display,
+    Scheduler &scheduler, RenderMode renderMode)
+    : _state{.lastUpdate = scheduler.Now()},
       _mmu(mmu),
       _display(display),
-      _oamPhase(_mmu),
-      _pixelrenderingPhase(_mmu, _display),
-      _hblankPhase(),
-      _vblankPhase(_mmu, _ly),
-      _phase(&_oamPhase),
-      _mode(PpuMode::OamSearch)
+      _scheduler(scheduler),
+      _oamPhase(_mmu, _oamRam),
+      _pixelrenderingPhase(_mmu, vram, _display, _oamPhase),
+      _scanlineRenderer(_mmu, vram, _display),
+      _renderMode(renderMode),
+      _phase(nullptr)
 {
-  _phase->Start();
+  _scheduler.SetHandler(Scheduler::EventType::PpuModeChange, [this]() {
+    CatchUp();
+    ScheduleModeChange();
+  });
+  EnterMode(PpuMode::OamSearch);
+  ScheduleModeChange();
 }
 
-void Ppu::Tick(int cycles)
+void Ppu::CatchUp()
 {
-  while (cycles--)
+  auto now = _scheduler.Now();
+  if (now == _state.lastUpdate)
   {
-    Tick();
+    return;
   }
+  // update lastUpdate first, phases read ppu registers through the mmu which
+  // calls back into CatchUp
+  auto dots = now - _state.lastUpdate;
+  _state.lastUpdate = now;
+  Tick(static_cast<unsigned int>(dots));
 }
 
-void Ppu::Tick()
+void Ppu::WriteOam(std::span<const std::uint8_t, OAM_SIZE> data)
 {
-  ++_dotsThisLine;
-  if (_phase && _phase->Tick())
-  {
-    SetPpuModeInStatRegister(_mode);
+  CatchUp();
+  _oamRam.WriteAll(data);
+}
 
-    // Check if _lyc register is equal to _ly and set the flag in _lcdStatus
-    // register if true
-    if (_ly == _lyc)
-    {
-      BitUtils::Set<2>(_lcdStatus);
-    }
+void Ppu::SaveState(SaveStateWriter &writer) const
+{
+  writer.Write(_renderMode);
+  writer.Write(_state);
+  _oamRam.SaveState(writer);
+  _oamPhase.SaveState(writer);
+  _pixelrenderingPhase.SaveState(writer);
+}
 
-    // Check if any condition for raising the stat interrupt is true
-    _currentStatLineStatus =
-        (BitUtils::Test<3>(_lcdStatus) && _mode == PpuMode::HBlank)
-        || (BitUtils::Test<4>(_lcdStatus) && _mode == PpuMode::VBlank)
-        || (BitUtils::Test<5>(_lcdStatus) && _mode == PpuMode::OamSearch)
-        || (BitUtils::Test<6>(_lcdStatus) && BitUtils::Test<2>(_lcdStatus));
+void Ppu::LoadState(SaveStateReader &reader)
+{
+  // phases only keep their state in dot mode, so a state can only be loaded
+  // with the render mode it was saved with. Checked before anything is loaded
+  RenderMode renderMode{};
+  reader.Read(renderMode);
+  if (renderMode != _renderMode)
+  {
+    throw std::runtime_error("Save state was made with another render mode");
+  }
+  reader.Read(_state);
+  _oamRam.LoadState(reader);
+  _oamPhase.LoadState(reader);
+  _pixelrenderingPhase.LoadState(reader);
 
-    // Raise interrupt only on the rising edge, i.e previou stat line status was
-    // false and now it's true
-    if (_currentStatLineStatus && !_previousStatLineStatus)
+  _phase = nullptr;
+  if (_renderMode == RenderMode::Dot)
+  {
+    if (_state.mode == PpuMode::OamSearch)
+    {
+      _phase = &_oamPhase;
+    }
+    else if (_state.mode == PpuMode::PixelRendering)
     {
-      _mmu.RequestInterrupt(InterruptType::LCD);
+      _phase = &_pixelrenderingPhase;
     }
   }
-  else
+}
+
+void Ppu::Tick(unsigned int dots)
+{
+  while (dots > 0)
   {
-    // switch phase here
-    _phase = nullptr;
-    switch (_mode)
+    if (_phase)
     {
-      case PpuMode::OamSearch:
+      // oam search and pixel rendering do work every dot
+      ++_state.dotsThisLine;
+      --dots;
+      if (!_phase->Tick())
       {
-        _mode = PpuMode::PixelRendering;
-        _phase = &_pixelrenderingPhase;
-        _pixelrenderingPhase.Start();
-        break;
+        EnterMode(_state.mode == PpuMode::OamSearch ? PpuMode::PixelRendering
+                                              : PpuMode::HBlank);
+      }
+    }
+    else
+    {
+      // nothing happens in hblank and vblank until the end of the line, or
+      // in scanline mode until the end of the mode
+      auto endDot = ModeEndDot();
+      auto step = std::min(dots, endDot - _state.dotsThisLine);
+      _state.dotsThisLine += step;
+      dots -= step;
+      if (_state.dotsThisLine < endDot)
+      {
+        continue;
+      }
+      if (_state.mode == PpuMode::OamSearch)
+      {
+        EnterMode(PpuMode::PixelRendering);
+      }
+      else if (_state.mode == PpuMode::PixelRendering)
+      {
+        EnterMode(PpuMode::HBlank);
+      }
+      else
+      {
+        NextLine();
       }
-      case PpuMode::PixelRendering:
+    }
+  }
+}
+
+void Ppu::EnterMode(PpuMode mode)
+{
+  _state.mode = mode;
+  switch (_state.mode)
+  {
+    case PpuMode::OamSearch:
+      // the window can only start on a line once LY matched WY this frame
+      if (_state.ly == _state.wy)
       {
-        _mode = PpuMode::HBlank;
-        _phase = &_hblankPhase;
-        auto hblankLength = 456 - _dotsThisLine;
-        _hblankPhase.SetHBlankModeLength(hblankLength);
+        _state.windowYTriggered = true;
+      }
+      if (_renderMode == RenderMode::Dot)
+      {
+        _phase = &_oamPhase;
         _phase->Start();
-        break;
       }
-      case PpuMode::HBlank:
+      break;
+    case PpuMode::PixelRendering:
+      UpdateWindowOnLine();
+      if (_renderMode == RenderMode::Dot)
       {
-        ++_ly;
-        if (_ly < 144)
+        if (_state.windowOnLine)
         {
-          _mode = PpuMode::OamSearch;
-          _phase = &_oamPhase;
-          _phase->Start();
+          // below 7 the window starts left of the screen
+          unsigned int wx{_state.wx};
+          _pixelrenderingPhase.SetWindow(std::max(wx, WX_OFFSET) - WX_OFFSET,
+              WX_OFFSET - std::min(wx, WX_OFFSET), _state.windowLine);
         }
         else
         {
-          _mode = PpuMode::VBlank;
-          _phase = &_vblankPhase;
-          _phase->Start();
+          _pixelrenderingPhase.SetWindow(
+              PixelRendering::NO_WINDOW, 0, _state.windowLine);
         }
-        break;
+        _phase = &_pixelrenderingPhase;
+        _phase->Start();
       }
-      case PpuMode::VBlank:
+      else
       {
-        _display.UpdateFrame();
-        _ly = 0;
-        _mode = PpuMode::OamSearch;
-        _phase = &_oamPhase;
-        _oamPhase.Start();
-        break;
+        // same length the pixel fifo takes for the line, it stands still for
+        // every sprite it fetches and when the window starts
+        _oamRam.FindSprites(
+            _state.ly, BitUtils::Test<2>(_state.lcdc), _scanlineSprites);
+        _state.pixelRenderingDots =
+            SCANLINE_PIXEL_RENDERING_DOTS + (_state.scx & 0x7U);
+        if (BitUtils::Test<1>(_state.lcdc))
+        {
+          for (std::size_t i{0}; i < _scanlineSprites.count; ++i)
+          {
+            // sprites right of the screen are never fetched
+            if (_scanlineSprites.sprites[i].x < SCREEN_WIDTH + 8)
+            {
+              _state.pixelRenderingDots += PixelRendering::SPRITE_FETCH_DOTS;
+            }
+          }
+        }
+        if (_state.windowOnLine)
+        {
+          _state.pixelRenderingDots += PixelRendering::WINDOW_START_DOTS;
+        }
       }
-    }
+      break;
+    case PpuMode::HBlank:
+      _phase = nullptr;
+      if (_renderMode == RenderMode::Scanline)
+      {
+        _oamRam.FindSprites(
+            _state.ly, BitUtils::Test<2>(_state.lcdc), _scanlineSprites);
+        _scanlineRenderer.RenderLine({.ly = _state.ly,
+                                         .lcdc = _state.lcdc,
+                                         .scx = _state.scx,
+                                         .scy = _state.scy,
+                                         .bgp = _state.bgp,
+                                         .obp0 = _state.obp0,
+                                         .obp1 = _state.obp1,
+                                         .wx = _state.wx,
+                                         .windowLine = _state.windowLine,
+                                         .windowOnLine = _state.windowOnLine},
+            _scanlineSprites);
+      }
+      if (_state.windowOnLine)
+      {
+        ++_state.windowLine;
+      }
+      break;
+    case PpuMode::VBlank:
+      _phase = nullptr;
+      break;
   }
-  if (_dotsThisLine >= MAX_DOTS_PER_SCANLINE)
+  SetPpuModeInStatRegister(_state.mode);
+  UpdateStatLine();
+}
+
+void Ppu::NextLine()
+{
+  _state.dotsThisLine = 0;
+  ++_state.ly;
+  if (_state.ly < 144)
   {
-    _dotsThisLine = 0;
+    EnterMode(PpuMode::OamSearch);
+  }
+  else if (_state.ly == 144)
+  {
+    // every visible line is drawn, hand the frame over at the start of vblank
+    _display.UpdateFrame();
+    ++_state.frameCount;
+    EnterMode(PpuMode::VBlank);
+    _mmu.RequestInterrupt(InterruptType::VBLANK);
+  }
+  else if (_state.ly > 153)
+  {
+    _state.ly = 0;
+    _state.windowLine = 0;
+    _state.windowYTriggered = false;
+    EnterMode(PpuMode::OamSearch);
+  }
+  else
+  {
+    // still in vblank, only LY changed
+    UpdateStatLine();
   }
 }
 
+unsigned int Ppu::ModeEndDot() const
+{
+  switch (_state.mode)
+  {
+    case PpuMode::OamSearch:
+      return OAM_SEARCH_DOTS;
+    case PpuMode::PixelRendering:
+      return OAM_SEARCH_DOTS + _state.pixelRenderingDots;
+    case PpuMode::HBlank:
+    case PpuMode::VBlank:
+      break;
+  }
+  return MAX_DOTS_PER_SCANLINE;
+}
+
+void Ppu::ScheduleModeChange()
+{
+  unsigned int dots{};
+  if (_phase == nullptr)
+  {
+    dots = ModeEndDot() - _state.dotsThisLine;
+  }
+  else if (_state.mode == PpuMode::OamSearch)
+  {
+    // oam search takes 80 dots
+    dots = OAM_SEARCH_DOTS - _state.dotsThisLine;
+  }
+  else
+  {
+    // at most one pixel is pushed each dot, so pixel rendering can't end
+    // before the remaining pixels are pushed
+    dots = std::max(1U, _pixelrenderingPhase.PixelsRemaining());
+  }
+  _scheduler.Schedule(
+      Scheduler::EventType::PpuModeChange, _state.lastUpdate + dots);
+}
+
+void Ppu::UpdateStatLine()
+{
+  // Check if lyc register is equal to ly and set the flag in lcdStatus
+  // register if true
+  if (_state.ly == _state.lyc)
+  {
+    BitUtils::Set<2>(_state.lcdStatus);
+  }
+  else
+  {
+    BitUtils::Unset<2>(_state.lcdStatus);
+  }
+
+  // Check if any condition for raising the stat interrupt is true
+  _state.currentStatLineStatus =
+      (BitUtils::Test<3>(_state.lcdStatus)
+          && _state.mode == PpuMode::HBlank)
+      || (BitUtils::Test<4>(_state.lcdStatus)
+          && _state.mode == PpuMode::VBlank)
+      || (BitUtils::Test<5>(_state.lcdStatus)
+          && _state.mode == PpuMode::OamSearch)
+      || (BitUtils::Test<6>(_state.lcdStatus)
+          && BitUtils::Test<2>(_state.lcdStatus));
+
+  // Raise interrupt only on the rising edge, i.e previou stat line status was
+  // false and now it's true
+  if (_state.currentStatLineStatus && !_state.previousStatLineStatus)
+  {
+    _mmu.RequestInterrupt(InterruptType::LCD);
+  }
+  _state.previousStatLineStatus = _state.currentStatLineStatus;
+}
+
 bool Ppu::Contains(std::uint16_t addr) const
 {
   return addr == LY_REGISTER_ADDRESS || addr == LYC_REGISTER_ADDRESS
          || addr == LCDC_REGISTER_ADDRESS || addr == SCX_REGISTER_ADDRESS
          || addr == SCY_REGISTER_ADDRESS || addr == BGP_REGISTER_ADDRESS
          || addr == OBP0_REGISTER_ADDRESS || addr == OBP1_REGISTER_ADDRESS
-         || addr == LCD_STAT_REGISTER_ADDRESS || _oamRam.Contains(addr);
+         || addr == LCD_STAT_REGISTER_ADDRESS || addr == WY_REGISTER_ADDRESS
+         || addr == WX_REGISTER_ADDRESS || _oamRam.Contains(addr);
 }
 
 std::uint8_t Ppu::Read(std::uint16_t addr) const
 {
+  // registers have to be caught up before reading them, ppu is never created
+  // const so casting it away is safe
+  const_cast<Ppu *>(this)->CatchUp();
   if (addr == LY_REGISTER_ADDRESS)
   {
-    return _ly;
+    return _state.ly;
   }
   else if (addr == LYC_REGISTER_ADDRESS)
   {
-    return _lyc;
+    return _state.lyc;
   }
   else if (addr == LCDC_REGISTER_ADDRESS)
   {
-    return _lcdc;
+    return _state.lcdc;
   }
   else if (addr == LCD_STAT_REGISTER_ADDRESS)
   {
-    return _lcdStatus;
+    return _state.lcdStatus;
   }
   else if (addr == SCX_REGISTER_ADDRESS)
   {
-    return _scx;
+    return _state.scx;
   }
   else if (addr == SCY_REGISTER_ADDRESS)
   {
-    return _scy;
+    return _state.scy;
   }
   else if (addr == BGP_REGISTER_ADDRESS)
   {
-    return _bgp;
+    return _state.bgp;
   }
   else if (addr == OBP0_REGISTER_ADDRESS)
   {
-    return _obp0;
+    return _state.obp0;
   }
   else if (addr == OBP1_REGISTER_ADDRESS)
   {
-    return _obp1;
+    return _state.obp1;
+  }
+  else if (addr == WY_REGISTER_ADDRESS)
+  {
+    return _state.wy;
+  }
+  else if (addr == WX_REGISTER_ADDRESS)
+  {
+    return _state.wx;
   }
   else if (_oamRam.Contains(addr))
   {
@@ -171,37 +391,51 @@ std::uint8_t Ppu::Read(std::uint16_t addr) const
 
 void Ppu::Write(std::uint16_t addr, std::uint8_t data)
 {
+  // render up to now with the old register values first
+  CatchUp();
   if (addr == LCDC_REGISTER_ADDRESS)
   {
-    _lcdc = data;
+    _state.lcdc = data;
   }
   else if (addr == LYC_REGISTER_ADDRESS)
   {
-    _lyc = data;
+    _state.lyc = data;
+    UpdateStatLine();
   }
   else if (addr == LCD_STAT_REGISTER_ADDRESS)
   {
-    _lcdStatus = data;
+    // mode and LYC flag (bits 0-2) are read only
+    _state.lcdStatus = static_cast<std::uint8_t>(
+        (_state.lcdStatus & 0x07U) | (data & 0x78U));
+    UpdateStatLine();
   }
   else if (addr == SCX_REGISTER_ADDRESS)
   {
-    _scx = data;
+    _state.scx = data;
   }
   else if (addr == SCY_REGISTER_ADDRESS)
   {
-    _scy = data;
+    _state.scy = data;
   }
   else if (addr == BGP_REGISTER_ADDRESS)
   {
-    _bgp = data;
+    _state.bgp = data;
   }
   else if (addr == OBP0_REGISTER_ADDRESS)
   {
-    _obp0 = data;
+    _state.obp0 = data;
   }
   else if (addr == OBP1_REGISTER_ADDRESS)
   {
-    _obp1 = data;
+    _state.obp1 = data;
+  }
+  else if (addr == WY_REGISTER_ADDRESS)
+  {
+    _state.wy = data;
+  }
+  else if (addr == WX_REGISTER_ADDRESS)
+  {
+    _state.wx = data;
   }
   else if (_oamRam.Contains(addr))
   {
@@ -211,41 +445,50 @@ void Ppu::Write(std::uint16_t addr, std::uint8_t data)
 
 std::uint8_t &Ppu::Address(std::uint16_t addr)
 {
+  CatchUp();
   if (addr == LY_REGISTER_ADDRESS)
   {
-    return _ly;
+    return _state.ly;
   }
   else if (addr == LYC_REGISTER_ADDRESS)
   {
-    return _lyc;
+    return _state.lyc;
   }
   else if (addr == LCDC_REGISTER_ADDRESS)
   {
-    return _lcdc;
+    return _state.lcdc;
   }
   else if (addr == LCD_STAT_REGISTER_ADDRESS)
   {
-    return _lcdStatus;
+    return _state.lcdStatus;
   }
   else if (addr == SCX_REGISTER_ADDRESS)
   {
-    return _scx;
+    return _state.scx;
   }
   else if (addr == SCY_REGISTER_ADDRESS)
   {
-    return _scy;
+    return _state.scy;
   }
   else if (addr == BGP_REGISTER_ADDRESS)
   {
-    return _bgp;
+    return _state.bgp;
   }
   else if (addr == OBP0_REGISTER_ADDRESS)
   {
-    return _obp0;
+    return _state.obp0;
   }
   else if (addr == OBP1_REGISTER_ADDRESS)
   {
-    return _obp1;
+    return _state.obp1;
+  }
+  else if (addr == WY_REGISTER_ADDRESS)
+  {
+    return _state.wy;
+  }
+  else if (addr == WX_REGISTER_ADDRESS)
+  {
+    return _state.wx;
   }
   else if (_oamRam.Contains(addr))
   {
@@ -253,9 +496,16 @@ std::uint8_t &Ppu::Address(std::uint16_t addr)
   }
 
   // if address is not presesnt, return dummy value
-  static std::uint8_t dummy;
-  dummy = 0xFF;
-  return dummy;
+  _unmapped = 0xFF;
+  return _unmapped;
+}
+
+void Ppu::UpdateWindowOnLine()
+{
+  // WX past the right edge of the screen hides the window
+  _state.windowOnLine = BitUtils::Test<5>(_state.lcdc)
+                        && _state.windowYTriggered
+                        && _state.wx < SCREEN_WIDTH + WX_OFFSET;
 }
 
 // Update Bit's 0 and 1 of lcd stat register based on PPU mode
@@ -264,18 +514,18 @@ void Ppu::SetPpuModeInStatRegister(PpuMode mode)
   auto modeNum = static_cast<std::uint8_t>(mode);
   if (BitUtils::Test<0>(modeNum))
   {
-    BitUtils::Set<0>(_lcdStatus);
+    BitUtils::Set<0>(_state.lcdStatus);
   }
   else
   {
-    BitUtils::Unset<0>(_lcdStatus);
+    BitUtils::Unset<0>(_state.lcdStatus);
   }
   if (BitUtils::Test<1>(modeNum))
   {
-    BitUtils::Set<1>(_lcdStatus);
+    BitUtils::Set<1>(_state.lcdStatus);
   }
   else
   {
-    BitUtils::Unset<1>(_lcdStatus);
+    BitUtils::Unset<1>(_state.lcdStatus);
   }
 }
@@ -1,15 +1,20 @@
 #pragma once
 
 #include <cstdint>
+#include <span>
 
+#include "common.hpp"
 #include "concretememoryrange.hpp"
 #include "display.hpp"
 #include "mmu.hpp"
-#include "phases/hblank.hpp"
+#include "oamram.hpp"
 #include "phases/oamsearch.hpp"
 #include "phases/pixelrendering.hpp"
 #include "phases/ppuphase.hpp"
-#include "phases/vblank.hpp"
+#include "savestate.hpp"
+#include "scanlinerenderer.hpp"
+#include "scheduler.hpp"
+#include "videoram.hpp"
 
 class Ppu : public MemoryRange
 {
@@ -22,11 +27,29 @@ public:
     PixelRendering = 3,
   };
 
+  enum class RenderMode : std::uint8_t
+  {
+    Dot,       // pixel fifo runs every dot, mid line register writes show up
+    Scanline,  // whole line is rendered at the start of hblank
+  };
+
 public:
-  Ppu(MemoryManagementUnit &mmu, Display &display);
+  Ppu(MemoryManagementUnit &mmu, VideoRam &vram, Display &display,
+      Scheduler &scheduler, RenderMode renderMode = RenderMode::Dot);
+
+  // Run the ppu up to the scheduler's current cycle
+  void CatchUp();
+
+  // Number of frames completed so far, a frame completes when vblank starts
+  [[nodiscard]]
+  std::uint64_t FrameCount() const
+  {
+    return _state.frameCount;
+  }
 
-  void Tick();
-  void Tick(int cycles);
+  // Replace all of oam at once, for OAM DMA. The ppu is caught up first so
+  // it sees the old oam up to now
+  void WriteOam(std::span<const std::uint8_t, OAM_SIZE> data);
 
 public:
   [[nodiscard]]
@@ -39,31 +62,81 @@ public:
 
   std::uint8_t &Address(std::uint16_t addr) override;
 
+  // Includes oam and the state of the phase in progress, the phase pointer
+  // is restored from the mode
+  void SaveState(SaveStateWriter &writer) const;
+  void LoadState(SaveStateReader &reader);
+
 private:
+  void Tick(unsigned int dots);
+  void EnterMode(PpuMode mode);
+  void NextLine();
+  // Dot of the line at which current mode ends, only for modes without a phase
+  [[nodiscard]]
+  unsigned int ModeEndDot() const;
+  // Schedule PpuModeChange event for the earliest dot the mode can change at
+  void ScheduleModeChange();
+  // Update LYC flag and request stat interrupt on a rising edge of stat line
+  void UpdateStatLine();
   void SetPpuModeInStatRegister(PpuMode mode);
+  // Decide whether the window is drawn on this line
+  void UpdateWindowOnLine();
 
 private:
-  ConcreteMemoryRange _oamRam;
-  std::uint8_t _ly{};
-  std::uint8_t _lyc{};
-  std::uint8_t _lcdc{};
-  std::uint8_t _scx{};
-  std::uint8_t _scy{};
-  std::uint8_t _bgp{};
-  std::uint8_t _obp0{};
-  std::uint8_t _obp1{};
-  std::uint8_t _lcdStatus{};
-  bool _currentStatLineStatus{};   // true if some stat condition is triggered
-  bool _previousStatLineStatus{};  // true if in previous tick stat condition
-                                   // was triggered
+  struct State
+  {
+    std::uint8_t ly{};
+    std::uint8_t lyc{};
+    std::uint8_t lcdc{};
+    std::uint8_t scx{};
+    std::uint8_t scy{};
+    std::uint8_t bgp{};
+    std::uint8_t obp0{};
+    std::uint8_t obp1{};
+    std::uint8_t wy{};
+    std::uint8_t wx{};
+    // internal window line counter, row of the window drawn on the next line
+    // with window. Only counts lines the window was drawn on
+    std::uint8_t windowLine{};
+    // LY matched WY on some line of this frame
+    bool windowYTriggered{};
+    // the window is drawn on this line, decided when pixel rendering starts
+    bool windowOnLine{};
+    std::uint8_t lcdStatus{};
+    bool currentStatLineStatus{};   // true if some stat condition is triggered
+    bool previousStatLineStatus{};  // true if in previous tick stat condition
+                                    // was triggered
+    PpuMode mode{PpuMode::OamSearch};
+
+    // cycle the ppu was last caught up to
+    std::uint64_t lastUpdate{};
+    unsigned int dotsThisLine{};
+    // length of pixel rendering in scanline mode, fixed when the mode starts
+    unsigned int pixelRenderingDots{};
+    std::uint64_t frameCount{};
+  };
+
+  OamRam _oamRam;
+  State _state;
   MemoryManagementUnit &_mmu;
   Display &_display;
+  Scheduler &_scheduler;
   OamSearch _oamPhase;
   PixelRendering _pixelrenderingPhase;
-  HBlank _hblankPhase;
-  VBlank _vblankPhase;
+  ScanlineRenderer _scanlineRenderer;
+  RenderMode _renderMode;
+  // phase that does work every dot, nullptr during hblank and vblank where
+  // nothing happens until the line ends, and always nullptr in scanline mode
   PpuPhase *_phase;
-  PpuMode _mode;
+  // sprites of the line in scanline mode, looked up again when the line is
+  // rendered so they're not part of a save state
+  OamRam::SpriteLine _scanlineSprites{};
+  // handed out by Address for addresses the ppu doesn't own
+  std::uint8_t _unmapped{0xFF};
 
-  unsigned int _dotsThisLine{};
+  // pixel rendering length of the pixel fifo for a line with no sprites or
+  // window, not counting the SCX & 7 pixels dropped at the start of the line
+  constexpr static unsigned int SCANLINE_PIXEL_RENDERING_DOTS{173};
+  // WX holds the screen x of the window + 7
+  constexpr static unsigned int WX_OFFSET{7};
 };
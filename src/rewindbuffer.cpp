@@ -0,0 +1,162 @@
+#include "rewindbuffer.hpp"
+
+#include <cstring>
+#include <utility>
+
+#include "leb128.hpp"
+
+RewindBuffer::RewindBuffer(std::size_t capacity, unsigned int interval)
+    : _ring(capacity), _interval(interval)
+{
+}
+
+void RewindBuffer::OnFrame(const Machine &machine)
+{
+  if (++_framesSinceSnapshot < _interval)
+  {
+    return;
+  }
+  _framesSinceSnapshot = 0;
+
+  machine.SaveState(_snapshot);
+  if (_latest.size() == _snapshot.size())
+  {
+    EncodeDelta(_latest, _snapshot);
+    PushDelta();
+  }
+  else
+  {
+    // first snapshot, there is nothing to go back to from it
+    _deltas.clear();
+  }
+  std::swap(_latest, _snapshot);
+}
+
+bool RewindBuffer::Rewind(Machine &machine)
+{
+  if (_latest.empty())
+  {
+    return false;
+  }
+  machine.LoadState(_latest);
+  if (_deltas.empty())
+  {
+    _latest.clear();
+  }
+  else
+  {
+    auto delta = _deltas.back();
+    _deltas.pop_back();
+    ApplyDelta(
+        std::span{_ring}.subspan(delta.offset, delta.size), _latest);
+  }
+  _framesSinceSnapshot = 0;
+  return true;
+}
+
+std::size_t RewindBuffer::SnapshotCount() const
+{
+  return _latest.empty() ? 0 : _deltas.size() + 1;
+}
+
+std::size_t RewindBuffer::UsedBytes() const
+{
+  std::size_t used{};
+  for (const auto &delta : _deltas)
+  {
+    used += delta.size;
+  }
+  return used;
+}
+
+// A delta is a list of (zero run, literal length, literal bytes), the
+// literal bytes are the xor of both snapshots. Zeros after the last literal
+// are left out
+void RewindBuffer::EncodeDelta(const std::vector<std::uint8_t> &from,
+    const std::vector<std::uint8_t> &to)
+{
+  _encoded.clear();
+  auto size = to.size();
+  std::size_t pos{};
+  while (pos < size)
+  {
+    auto zeroStart = pos;
+    while (pos < size && from[pos] == to[pos])
+    {
+      ++pos;
+    }
+    if (pos == size)
+    {
+      break;
+    }
+
+    // the literal ends at the first run of MIN_ZERO_RUN zeros
+    auto literalStart = pos;
+    auto literalEnd = pos;
+    while (pos < size && pos - literalEnd < MIN_ZERO_RUN)
+    {
+      if (from[pos] != to[pos])
+      {
+        literalEnd = pos + 1;
+      }
+      ++pos;
+    }
+    pos = literalEnd;
+
+    Leb128::Write(_encoded, literalStart - zeroStart);
+    Leb128::Write(_encoded, literalEnd - literalStart);
+    for (auto i = literalStart; i < literalEnd; ++i)
+    {
+      _encoded.push_back(static_cast<std::uint8_t>(from[i] ^ to[i]));
+    }
+  }
+}
+
+void RewindBuffer::ApplyDelta(
+    std::span<const std::uint8_t> delta, std::vector<std::uint8_t> &snapshot)
+{
+  std::size_t in{};
+  std::size_t out{};
+  while (in < delta.size())
+  {
+    out += Leb128::Read(delta, in);
+    auto literal = Leb128::Read(delta, in);
+    for (std::size_t i{0}; i < literal; ++i)
+    {
+      snapshot[out++] ^= delta[in++];
+    }
+  }
+}
+
+void RewindBuffer::PushDelta()
+{
+  auto size = _encoded.size();
+  if (size > _ring.size())
+  {
+    // older snapshots can't be reached without this delta
+    _deltas.clear();
+    return;
+  }
+
+  // deltas are stored one after another, the oldest ones are right after the
+  // newest and get overwritten first
+  std::size_t offset =
+      _deltas.empty() ? 0 : _deltas.back().offset + _deltas.back().size;
+  if (offset + size > _ring.size())
+  {
+    // doesn't fit before the end, the deltas stored there are dropped too
+    while (!_deltas.empty() && _deltas.front().offset >= offset)
+    {
+      _deltas.pop_front();
+    }
+    offset = 0;
+  }
+  while (!_deltas.empty() && _deltas.front().offset >= offset
+         && _deltas.front().offset < offset + size)
+  {
+    _deltas.pop_front();
+  }
+
+  std::memcpy(_ring.data() + offset, _encoded.data(), size);
+  _deltas.push_back({.offset = offset, .size = size});
+}
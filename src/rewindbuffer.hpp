@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <span>
+#include <vector>
+
+#include "machine.hpp"
+
+// History of save states for rewinding. A snapshot is taken every interval
+// frames, only the latest one is kept whole. Older ones are kept as the xor
+// against the snapshot after them, run length encoded. Most of the machine
+// doesn't change in a few frames so the xor is mostly zeros and a snapshot
+// takes a few hundred bytes instead of the whole state.
+//
+// Deltas live in a ring buffer of fixed capacity, when it's full the oldest
+// snapshots are dropped. Taking a snapshot costs one save state plus a single
+// pass over it, so it's bounded by the state size on every frame it happens.
+class RewindBuffer
+{
+public:
+  RewindBuffer(std::size_t capacity, unsigned int interval);
+
+  // Call once per emulated frame, takes a snapshot every interval frames
+  void OnFrame(const Machine &machine);
+
+  // Load the latest snapshot into machine and drop it, so every call goes
+  // further back. Returns false once there is no history left
+  bool Rewind(Machine &machine);
+
+  // Number of snapshots that can be rewound to
+  [[nodiscard]]
+  std::size_t SnapshotCount() const;
+
+  // Bytes of the ring buffer used by deltas
+  [[nodiscard]]
+  std::size_t UsedBytes() const;
+
+private:
+  struct Delta
+  {
+    std::size_t offset;
+    std::size_t size;
+  };
+
+  // Run length encode the xor of two snapshots of the same size into _encoded
+  void EncodeDelta(const std::vector<std::uint8_t> &from,
+      const std::vector<std::uint8_t> &to);
+  // Xor an encoded delta back into snapshot
+  static void ApplyDelta(std::span<const std::uint8_t> delta,
+      std::vector<std::uint8_t> &snapshot);
+  // Copy _encoded into the ring, dropping the oldest deltas it overlaps
+  void PushDelta();
+
+  // zero runs shorter than this are kept in the literal around them, each run
+  // costs at least two length bytes
+  constexpr static std::size_t MIN_ZERO_RUN{4};
+
+  std::vector<std::uint8_t> _ring;
+  // deltas in the ring, oldest first
+  std::deque<Delta> _deltas;
+  unsigned int _interval;
+  unsigned int _framesSinceSnapshot{};
+
+  // latest snapshot, empty if there is none
+  std::vector<std::uint8_t> _latest;
+  // scratch buffers reused between snapshots
+  std::vector<std::uint8_t> _snapshot;
+  std::vector<std::uint8_t> _encoded;
+};
@@ -0,0 +1,112 @@
+#include "romimage.hpp"
+
+#include <format>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+#ifdef _WIN32
+// Map the whole file, the file and mapping handles can be closed right away,
+// the view keeps the mapping alive until it's unmapped
+std::span<const std::uint8_t> MapFile(const std::string &filePath)
+{
+  HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ,
+      nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+  {
+    throw std::runtime_error(std::format("Failed to open rom: {}", filePath));
+  }
+  LARGE_INTEGER size{};
+  if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+  {
+    CloseHandle(file);
+    throw std::runtime_error("Failed to read rom");
+  }
+  HANDLE mapping =
+      CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  CloseHandle(file);
+  if (mapping == nullptr)
+  {
+    throw std::runtime_error(std::format("Failed to map rom: {}", filePath));
+  }
+  void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  CloseHandle(mapping);
+  if (data == nullptr)
+  {
+    throw std::runtime_error(std::format("Failed to map rom: {}", filePath));
+  }
+  return {static_cast<const std::uint8_t *>(data),
+      static_cast<std::size_t>(size.QuadPart)};
+}
+
+void UnmapFile(const std::uint8_t *data, [[maybe_unused]] std::size_t size)
+{
+  UnmapViewOfFile(data);
+}
+#else
+// Map the whole file, the descriptor can be closed right away, the mapping
+// keeps the file alive until it's unmapped
+std::span<const std::uint8_t> MapFile(const std::string &filePath)
+{
+  int file = open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+  if (file == -1)
+  {
+    throw std::runtime_error(std::format("Failed to open rom: {}", filePath));
+  }
+  struct stat status{};
+  if (fstat(file, &status) == -1 || status.st_size <= 0)
+  {
+    close(file);
+    throw std::runtime_error("Failed to read rom");
+  }
+  auto size = static_cast<std::size_t>(status.st_size);
+  void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+  close(file);
+  if (data == MAP_FAILED)
+  {
+    throw std::runtime_error(std::format("Failed to map rom: {}", filePath));
+  }
+  return {static_cast<const std::uint8_t *>(data), size};
+}
+
+void UnmapFile(const std::uint8_t *data, std::size_t size)
+{
+  // munmap takes a non const pointer but doesn't write through it
+  munmap(const_cast<std::uint8_t *>(data), size);
+}
+#endif
+}  // namespace
+
+std::shared_ptr<const RomImage> RomImage::Open(const std::string &filePath)
+{
+  auto data = MapFile(filePath);
+  // the constructor is private, so no make_shared
+  return std::shared_ptr<const RomImage>(
+      new RomImage(data.data(), data.size()));
+}
+
+RomImage::RomImage(const std::uint8_t *data, std::size_t size)
+    : _data(data), _size(size)
+{
+}
+
+RomImage::~RomImage()
+{
+  UnmapFile(_data, _size);
+}
+
+std::span<const std::uint8_t> RomImage::Data() const
+{
+  return {_data, _size};
+}
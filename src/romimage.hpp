@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+
+// Contents of a rom file, mapped read only into memory instead of read into
+// a buffer. Pages are loaded by the os on first access and shared through its
+// page cache, and machines running the same game can share one image, so
+// starting many instances costs neither a copy nor a read of the whole file.
+//
+// The mapping is read only, nothing may write into Data(). Writes to rom
+// addresses are mapper control and must be handled by whoever owns the rom.
+class RomImage
+{
+public:
+  // Map the file at filePath, throws std::runtime_error if it can't be opened
+  // or is empty
+  [[nodiscard]]
+  static std::shared_ptr<const RomImage> Open(const std::string &filePath);
+
+  RomImage(const RomImage &) = delete;
+  RomImage &operator=(const RomImage &) = delete;
+  RomImage(RomImage &&) = delete;
+  RomImage &operator=(RomImage &&) = delete;
+  ~RomImage();
+
+  [[nodiscard]]
+  std::span<const std::uint8_t> Data() const;
+
+private:
+  RomImage(const std::uint8_t *data, std::size_t size);
+
+  const std::uint8_t *_data;
+  std::size_t _size;
+};
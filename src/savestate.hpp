@@ -0,0 +1,90 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+// Save states are the raw bytes of each component's state, written one
+// block after another. A block is either a trivially copyable state struct or
+// a plain memory area, so saving and loading is a memcpy per block.
+//
+// Blocks are stored in host layout, a save state can only be loaded by a build
+// with the same SAVE_STATE_VERSION on the same platform. Bump the version
+// whenever a state struct or the block order changes.
+constexpr std::array<char, 4> SAVE_STATE_MAGIC{'N', 'B', 'S', 'S'};
+constexpr std::uint32_t SAVE_STATE_VERSION{6};
+
+struct SaveStateHeader
+{
+  std::array<char, 4> magic;
+  std::uint32_t version;
+  // size of the whole save state including the header
+  std::uint64_t size;
+};
+
+class SaveStateWriter
+{
+public:
+  // Appends to buffer, clear it first to reuse its capacity between saves
+  explicit SaveStateWriter(std::vector<std::uint8_t> &buffer) : _buffer(buffer)
+  {
+  }
+
+  template <typename T>
+  void Write(const T &block)
+  {
+    static_assert(std::is_trivially_copyable_v<T>,
+        "save state blocks must be trivially copyable");
+    WriteMemory(
+        std::span{reinterpret_cast<const std::uint8_t *>(&block), sizeof(T)});
+  }
+
+  void WriteMemory(std::span<const std::uint8_t> memory)
+  {
+    if (memory.empty())
+    {
+      return;
+    }
+    auto oldSize = _buffer.size();
+    _buffer.resize(oldSize + memory.size());
+    std::memcpy(_buffer.data() + oldSize, memory.data(), memory.size());
+  }
+
+private:
+  std::vector<std::uint8_t> &_buffer;
+};
+
+class SaveStateReader
+{
+public:
+  explicit SaveStateReader(std::span<const std::uint8_t> buffer)
+      : _buffer(buffer)
+  {
+  }
+
+  template <typename T>
+  void Read(T &block)
+  {
+    static_assert(std::is_trivially_copyable_v<T>,
+        "save state blocks must be trivially copyable");
+    ReadMemory(std::span{reinterpret_cast<std::uint8_t *>(&block), sizeof(T)});
+  }
+
+  void ReadMemory(std::span<std::uint8_t> memory)
+  {
+    if (memory.size() > _buffer.size() - _position)
+    {
+      throw std::runtime_error("Save state is truncated");
+    }
+    std::memcpy(memory.data(), _buffer.data() + _position, memory.size());
+    _position += memory.size();
+  }
+
+private:
+  std::span<const std::uint8_t> _buffer;
+  std::size_t _position{};
+};
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "bitutils.hpp"
+#include "color.hpp"
+#include "common.hpp"
+#include "display.hpp"
+#include "fetcher.hpp"
+#include "mmu.hpp"
+#include "oamram.hpp"
+#include "videoram.hpp"
+
+// Renders a whole line at once from the registers at the start of hblank, used
+// instead of the pixel fifo when mid line effects don't matter
+class ScanlineRenderer
+{
+public:
+  ScanlineRenderer(MemoryManagementUnit &mmu, VideoRam &vram, Display &display)
+      : _mmu(mmu), _vram(vram), _display(display)
+  {
+  }
+
+  // Registers a line is rendered with, as they are when hblank starts
+  struct LineRegisters
+  {
+    std::uint8_t ly;
+    std::uint8_t lcdc;
+    std::uint8_t scx;
+    std::uint8_t scy;
+    std::uint8_t bgp;
+    std::uint8_t obp0;
+    std::uint8_t obp1;
+    std::uint8_t wx;
+    // internal window line counter of the ppu
+    std::uint8_t windowLine;
+    bool windowOnLine;
+  };
+
+  // sprites are the ones oam search picks for the line
+  void RenderLine(
+      const LineRegisters &registers, const OamRam::SpriteLine &sprites)
+  {
+    RenderBackground(registers);
+    if (BitUtils::Test<1>(registers.lcdc))
+    {
+      RenderSprites(registers, sprites);
+    }
+    _display.DrawLine(registers.ly, _line);
+  }
+
+private:
+  // WX holds the screen x of the window + 7
+  constexpr static unsigned int WX_OFFSET{7};
+
+  void RenderBackground(const LineRegisters &registers)
+  {
+    auto lcdc = registers.lcdc;
+    const std::array<std::uint8_t, 4> shades{PaletteShade(registers.bgp, 0),
+        PaletteShade(registers.bgp, 1), PaletteShade(registers.bgp, 2),
+        PaletteShade(registers.bgp, 3)};
+
+    // the window covers the line from its start to the right edge
+    unsigned int windowStart{SCREEN_WIDTH};
+    if (registers.windowOnLine)
+    {
+      windowStart = std::max<unsigned int>(registers.wx, WX_OFFSET) - WX_OFFSET;
+    }
+
+    auto bgY = (registers.ly + registers.scy) & 0xFFU;
+    RenderTiles(BitUtils::Test<3>(lcdc), bgY, lcdc, 0, windowStart,
+        registers.scx, shades);
+    if (windowStart < SCREEN_WIDTH)
+    {
+      // screen x shows window x + 7 - WX
+      RenderTiles(BitUtils::Test<6>(lcdc), registers.windowLine, lcdc,
+          windowStart, SCREEN_WIDTH, WX_OFFSET - registers.wx, shades);
+    }
+  }
+
+  // Draw pixels [start, end) of the line from line y of a 256x256 tile map,
+  // screen x shows pixel (x + scroll) & 0xFF of the map line
+  void RenderTiles(bool highTileMap, unsigned int y, std::uint8_t lcdc,
+      unsigned int start, unsigned int end, unsigned int scroll,
+      const std::array<std::uint8_t, 4> &shades)
+  {
+    auto tileMapRow = static_cast<std::uint16_t>(
+        (highTileMap ? BG_WIN_TILEMAP_ADDRESS1 : BG_WIN_TILEMAP_ADDRESS0)
+        + (BG_WIN_TILEMAP_ROW_SIZE * (y / 8)));
+    const std::uint8_t *tileRow{};
+    for (unsigned int x{start}; x < end; ++x)
+    {
+      auto mapX = (scroll + x) & 0xFFU;
+      // fetch a new tile at every tile boundary, the first tile may be
+      // partially scrolled off the screen
+      if (x == start || (mapX & 0x7U) == 0)
+      {
+        auto tileIdx = _vram.ReadTileMap(
+            static_cast<std::uint16_t>(tileMapRow + (mapX / 8)));
+        tileRow = _vram.GetTileRow(
+            Fetcher::GetTileDataAddress(lcdc, tileIdx, y & 0x7U));
+      }
+      _bgColors[x] = tileRow[mapX & 0x7U];
+      _line[x] = shades[_bgColors[x]];
+    }
+  }
+
+  // Draw sprites over the background the way the pixel fifo mixes them in
+  void RenderSprites(
+      const LineRegisters &registers, const OamRam::SpriteLine &sprites)
+  {
+    auto ly = registers.ly;
+    auto lcdc = registers.lcdc;
+    // pixels taken by an opaque pixel of a sprite drawn earlier, even one
+    // hidden behind the background
+    std::array<bool, SCREEN_WIDTH> taken{};
+    for (std::size_t i{0}; i < sprites.count; ++i)
+    {
+      const auto &sprite = sprites.sprites[i];
+      const auto *row = _vram.GetTileRow(
+          OamRam::GetTileRowAddress(sprite, ly, BitUtils::Test<2>(lcdc)));
+      auto palette = BitUtils::Test<4>(sprite.flags) ? registers.obp1
+                                                     : registers.obp0;
+      auto xFlip = BitUtils::Test<5>(sprite.flags);
+      auto behindBg = BitUtils::Test<7>(sprite.flags);
+      for (unsigned int pixel{0}; pixel < 8; ++pixel)
+      {
+        // sprite x is the screen x + 8
+        unsigned int x = sprite.x + pixel;
+        if (x < 8 || x - 8 >= SCREEN_WIDTH)
+        {
+          continue;
+        }
+        x -= 8;
+        auto color = row[xFlip ? 7 - pixel : pixel];
+        if (color == 0 || taken[x])
+        {
+          continue;
+        }
+        taken[x] = true;
+        if (!behindBg || _bgColors[x] == 0)
+        {
+          _line[x] = PaletteShade(palette, color);
+        }
+      }
+    }
+  }
+
+  MemoryManagementUnit &_mmu;
+  VideoRam &_vram;
+  Display &_display;
+  std::array<std::uint8_t, SCREEN_WIDTH> _line{};
+  // color ids of the background pixels of the line, for sprite priority
+  std::array<std::uint8_t, SCREEN_WIDTH> _bgColors{};
+};
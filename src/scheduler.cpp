@@ -0,0 +1,104 @@
+#include "scheduler.hpp"
+
+#include <algorithm>
+#include <utility>
+
+void Scheduler::SetHandler(EventType type, EventHandler handler)
+{
+  _handlers[static_cast<std::size_t>(type)] = std::move(handler);
+}
+
+void Scheduler::Schedule(EventType type, std::uint64_t cycle)
+{
+  auto idx = static_cast<std::size_t>(type);
+  _pending[idx] = true;
+  _events.push_back(
+      {.cycle = cycle, .type = type, .generation = ++_generations[idx]});
+  std::push_heap(_events.begin(), _events.end(), Later);
+  PopStaleEvents();
+}
+
+void Scheduler::Cancel(EventType type)
+{
+  auto idx = static_cast<std::size_t>(type);
+  _pending[idx] = false;
+  ++_generations[idx];
+  PopStaleEvents();
+}
+
+void Scheduler::RunDueEvents()
+{
+  while (!_events.empty() && _events.front().cycle <= _now)
+  {
+    auto event = _events.front();
+    std::pop_heap(_events.begin(), _events.end(), Later);
+    _events.pop_back();
+
+    auto idx = static_cast<std::size_t>(event.type);
+    _pending[idx] = false;
+    // handler is free to schedule the next event of the same type
+    if (_handlers[idx])
+    {
+      _handlers[idx]();
+    }
+    PopStaleEvents();
+  }
+}
+
+void Scheduler::SaveState(SaveStateWriter &writer) const
+{
+  State state{.now = _now, .eventCycles = {}};
+  state.eventCycles.fill(NO_EVENT);
+  for (const auto &event : _events)
+  {
+    auto idx = static_cast<std::size_t>(event.type);
+    if (_pending[idx] && event.generation == _generations[idx])
+    {
+      state.eventCycles[idx] = event.cycle;
+    }
+  }
+  writer.Write(state);
+}
+
+void Scheduler::LoadState(SaveStateReader &reader)
+{
+  State state{};
+  reader.Read(state);
+  _now = state.now;
+  _events.clear();
+  _pending.fill(false);
+  for (std::size_t idx = 0; idx < EVENT_TYPE_COUNT; ++idx)
+  {
+    if (state.eventCycles[idx] != NO_EVENT)
+    {
+      Schedule(static_cast<EventType>(idx), state.eventCycles[idx]);
+    }
+  }
+  PopStaleEvents();
+}
+
+bool Scheduler::Later(const Event &a, const Event &b)
+{
+  if (a.cycle != b.cycle)
+  {
+    return a.cycle > b.cycle;
+  }
+  return a.type > b.type;
+}
+
+void Scheduler::PopStaleEvents()
+{
+  while (!_events.empty())
+  {
+    const auto &top = _events.front();
+    auto idx = static_cast<std::size_t>(top.type);
+    if (_pending[idx] && top.generation == _generations[idx])
+    {
+      break;
+    }
+    std::pop_heap(_events.begin(), _events.end(), Later);
+    _events.pop_back();
+  }
+  _nextEventTime = _events.empty() ? std::numeric_limits<std::uint64_t>::max()
+                                   : _events.front().cycle;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+
+#include "savestate.hpp"
+
+// Central cycle counter of the emulator. Components schedule an event for the
+// cycle they next need to run at (timer overflow, ppu mode change, ...) and
+// the cpu runs freely until the next event is due. Between events components
+// catch up lazily when their registers are accessed.
+class Scheduler
+{
+public:
+  enum class EventType : std::uint8_t
+  {
+    TimerOverflow,
+    PpuModeChange,
+    OamDmaEnd,
+    Count
+  };
+
+  using EventHandler = std::function<void()>;
+
+public:
+  // current time in cpu cycles (t-cycles)
+  [[nodiscard]]
+  std::uint64_t Now() const
+  {
+    return _now;
+  }
+
+  void Advance(int cycles)
+  {
+    _now += static_cast<std::uint64_t>(cycles);
+  }
+
+  // true if an event is due and RunDueEvents needs to be called
+  [[nodiscard]]
+  bool IsEventDue() const
+  {
+    return _now >= _nextEventTime;
+  }
+
+  // cycle of the next event, the maximum std::uint64_t while none is pending
+  [[nodiscard]]
+  std::uint64_t NextEventTime() const
+  {
+    return _nextEventTime;
+  }
+
+  [[nodiscard]]
+  bool HasPendingEvent() const
+  {
+    return _nextEventTime != std::numeric_limits<std::uint64_t>::max();
+  }
+
+  void SetHandler(EventType type, EventHandler handler);
+
+  // Schedule event at cycle, replaces the pending event of the same type
+  void Schedule(EventType type, std::uint64_t cycle);
+
+  void Cancel(EventType type);
+
+  // Run handlers of all events scheduled at or before Now()
+  void RunDueEvents();
+
+  // Handlers are not part of a save state, they stay as set by the components
+  void SaveState(SaveStateWriter &writer) const;
+  void LoadState(SaveStateReader &reader);
+
+private:
+  struct Event
+  {
+    std::uint64_t cycle;
+    EventType type;
+    // events are never removed from the heap, a rescheduled or cancelled
+    // event is detected by a stale generation and dropped when it's popped
+    std::uint32_t generation;
+  };
+
+  // comparator for a min heap ordered by cycle, ties are broken by type so
+  // event order is deterministic
+  static bool Later(const Event &a, const Event &b);
+
+  void PopStaleEvents();
+
+  constexpr static auto EVENT_TYPE_COUNT{
+      static_cast<std::size_t>(EventType::Count)};
+
+  // Pending events by type, the heap is rebuilt from it when loading a state
+  struct State
+  {
+    std::uint64_t now;
+    // NO_EVENT if the event isn't pending
+    std::array<std::uint64_t, EVENT_TYPE_COUNT> eventCycles;
+  };
+  constexpr static auto NO_EVENT{std::numeric_limits<std::uint64_t>::max()};
+
+  std::uint64_t _now{};
+  std::uint64_t _nextEventTime{std::numeric_limits<std::uint64_t>::max()};
+  std::vector<Event> _events;
+  std::array<std::uint32_t, EVENT_TYPE_COUNT> _generations{};
+  std::array<bool, EVENT_TYPE_COUNT> _pending{};
+  std::array<EventHandler, EVENT_TYPE_COUNT> _handlers{};
+};
@@ -1,20 +1,33 @@
 #include "sdldisplay.hpp"
 
+#include "color.hpp"
+
 SdlDisplay::SdlDisplay(const char *title)
-    : _window(nullptr),
-      _renderer(nullptr),
-      _pixels(
-          static_cast<unsigned long>(PIXEL_SIZE * LCD_WIDTH * LCD_HEIGHT), 0)
+    : _window(nullptr), _renderer(nullptr)
 {
   SDL_InitSubSystem(SDL_INIT_VIDEO);
   SDL_CreateWindowAndRenderer(title, LCD_WIDTH * SCALE, LCD_HEIGHT * SCALE,
       SDL_WINDOW_RESIZABLE, &_window, &_renderer);
-  _texture = SDL_CreateTexture(_renderer, SDL_PIXELFORMAT_RGB24,
+  // 32 bit format the renderer can use without converting
+  _texture = SDL_CreateTexture(_renderer, SDL_PIXELFORMAT_XRGB8888,
       SDL_TEXTUREACCESS_STREAMING, LCD_WIDTH, LCD_HEIGHT);
+  for (std::size_t shade{0}; shade < _shadePixels.size(); ++shade)
+  {
+    const auto &color = SHADE_COLORS[shade];
+    _shadePixels[shade] = (0xFFU << 24U)
+                          | (static_cast<std::uint32_t>(color.red) << 16U)
+                          | (static_cast<std::uint32_t>(color.green) << 8U)
+                          | color.blue;
+  }
+  LockTexture();
 }
 
 SdlDisplay::~SdlDisplay()
 {
+  if (_texturePixels != nullptr)
+  {
+    SDL_UnlockTexture(_texture);
+  }
   SDL_DestroyTexture(_texture);
   SDL_DestroyRenderer(_renderer);
   SDL_DestroyWindow(_window);
@@ -22,21 +35,44 @@ SdlDisplay::~SdlDisplay()
   SDL_Quit();
 }
 
-void SdlDisplay::Draw(const Pixel &pixel)
+void SdlDisplay::LockTexture()
+{
+  void *pixels{};
+  if (SDL_LockTexture(_texture, nullptr, &pixels, &_texturePitch))
+  {
+    _texturePixels = static_cast<std::uint8_t *>(pixels);
+  }
+  else
+  {
+    _texturePixels = nullptr;
+  }
+}
+
+void SdlDisplay::DrawLine(
+    unsigned int ly, std::span<const std::uint8_t, SCREEN_WIDTH> shades)
 {
-  auto idx = (LCD_WIDTH * PIXEL_SIZE * pixel.y) + (PIXEL_SIZE * pixel.x);
-  if (idx + 2 <= _pixels.size())
+  if (_texturePixels == nullptr || ly >= LCD_HEIGHT)
   {
-    _pixels[idx] = pixel.color.red;
-    _pixels[idx + 1] = pixel.color.green;
-    _pixels[idx + 2] = pixel.color.blue;
+    return;
+  }
+  // rows are _texturePitch bytes apart and 4 byte aligned
+  auto *row = reinterpret_cast<std::uint32_t *>(
+      _texturePixels + (static_cast<std::size_t>(_texturePitch) * ly));
+  for (auto shade : shades)
+  {
+    *row++ = _shadePixels[shade & 0x3U];
   }
 }
 
 void SdlDisplay::UpdateFrame()
 {
-  SDL_UpdateTexture(_texture, nullptr, _pixels.data(), LCD_WIDTH * PIXEL_SIZE);
+  // frame is already in the texture, unlocking uploads it
+  if (_texturePixels != nullptr)
+  {
+    SDL_UnlockTexture(_texture);
+  }
   SDL_RenderClear(_renderer);
   SDL_RenderTexture(_renderer, _texture, nullptr, nullptr);
   SDL_RenderPresent(_renderer);
+  LockTexture();
 }
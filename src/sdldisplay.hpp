@@ -2,7 +2,9 @@
 
 #include <SDL3/SDL.h>
 
-#include <vector>
+#include <array>
+#include <cstdint>
+#include <span>
 
 #include "display.hpp"
 
@@ -12,20 +14,27 @@ public:
   constexpr static int LCD_WIDTH{160};
   constexpr static int LCD_HEIGHT{144};
   constexpr static int SCALE{4};
-  constexpr static int PIXEL_SIZE{3};
 
 public:
   explicit SdlDisplay(const char *title);
 
   ~SdlDisplay() override;
 
-  void Draw(const Pixel &pixel) override;
+  void DrawLine(unsigned int ly,
+      std::span<const std::uint8_t, SCREEN_WIDTH> shades) override;
 
   void UpdateFrame() override;
 
 private:
+  // Lock the streaming texture so the next frame is written straight into it
+  void LockTexture();
+
   SDL_Window *_window;
   SDL_Renderer *_renderer;
   SDL_Texture *_texture;
-  std::vector<std::uint8_t> _pixels;
+  // texture memory while locked, nullptr if locking failed
+  std::uint8_t *_texturePixels{};
+  int _texturePitch{};
+  // XRGB8888 value of each dmg shade
+  std::array<std::uint32_t, 4> _shadePixels{};
 };
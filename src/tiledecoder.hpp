@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(GB_SIMD_NONE)
+// scalar decoder only
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#define GB_TILE_DECODER_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) \
+    || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GB_TILE_DECODER_SSE2
+#endif
+
+// Decoder for 2bpp tiles. Each of the 8 rows of a tile is a low byte holding
+// bit 0 and a high byte holding bit 1 of the color ids of 8 pixels, leftmost
+// pixel in bit 7. Decoded rows have one color id per byte, leftmost first
+namespace TileDecoder
+{
+constexpr std::size_t TILE_ROWS{8};
+constexpr std::size_t DECODED_ROW_SIZE{8};
+constexpr std::size_t DECODED_TILE_SIZE{TILE_ROWS * DECODED_ROW_SIZE};
+
+inline void DecodeTileRow(
+    std::uint8_t low, std::uint8_t high, std::uint8_t *colorIds)
+{
+  for (unsigned int i{0}; i < DECODED_ROW_SIZE; ++i)
+  {
+    unsigned int bitIndex = 7U - i;
+    unsigned int bit1 = (static_cast<unsigned int>(low) >> bitIndex) & 1U;
+    unsigned int bit2 = (static_cast<unsigned int>(high) >> bitIndex) & 1U;
+    colorIds[i] = static_cast<std::uint8_t>((bit2 << 1U) | bit1);
+  }
+}
+
+#if defined(GB_TILE_DECODER_AVX2)
+// Decode 4 rows, tile holds the 16 tile bytes in both 128 bit lanes and
+// lowIdx picks the low byte of a row for every pixel (2 rows per lane)
+inline void DecodeRows(__m256i tile, __m256i lowIdx, std::uint8_t *colorIds)
+{
+  // bit tested by each pixel, leftmost pixel is bit 7
+  const auto mask = _mm256_set1_epi64x(0x0102040810204080LL);
+  const auto one = _mm256_set1_epi8(1);
+  auto low = _mm256_shuffle_epi8(tile, lowIdx);
+  auto high = _mm256_shuffle_epi8(tile, _mm256_add_epi8(lowIdx, one));
+  auto bit1 = _mm256_and_si256(
+      _mm256_cmpeq_epi8(_mm256_and_si256(low, mask), mask), one);
+  auto bit2 = _mm256_and_si256(
+      _mm256_cmpeq_epi8(_mm256_and_si256(high, mask), mask),
+      _mm256_set1_epi8(2));
+  _mm256_storeu_si256(
+      reinterpret_cast<__m256i *>(colorIds), _mm256_or_si256(bit1, bit2));
+}
+#elif defined(GB_TILE_DECODER_SSE2)
+// Repeat a byte in all 8 bytes of a 64 bit lane
+inline long long Broadcast(std::uint8_t data)
+{
+  return static_cast<long long>(data * 0x0101010101010101ULL);
+}
+#endif
+
+// Decode all rows of a tile, tileData points to its 16 bytes and colorIds
+// receives DECODED_TILE_SIZE color ids
+inline void DecodeTile(const std::uint8_t *tileData, std::uint8_t *colorIds)
+{
+#if defined(GB_TILE_DECODER_AVX2)
+  auto tile = _mm256_broadcastsi128_si256(
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(tileData)));
+  DecodeRows(tile,
+      _mm256_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 2, 2, 2, 2, 2, 2, 2, 2, 4, 4, 4,
+          4, 4, 4, 4, 4, 6, 6, 6, 6, 6, 6, 6, 6),
+      colorIds);
+  DecodeRows(tile,
+      _mm256_setr_epi8(8, 8, 8, 8, 8, 8, 8, 8, 10, 10, 10, 10, 10, 10, 10, 10,
+          12, 12, 12, 12, 12, 12, 12, 12, 14, 14, 14, 14, 14, 14, 14, 14),
+      colorIds + (4 * DECODED_ROW_SIZE));
+#elif defined(GB_TILE_DECODER_SSE2)
+  // bit tested by each pixel, leftmost pixel is bit 7
+  const auto mask = _mm_set1_epi64x(0x0102040810204080LL);
+  const auto one = _mm_set1_epi8(1);
+  const auto two = _mm_set1_epi8(2);
+  // 2 rows at a time
+  for (std::size_t row{0}; row < TILE_ROWS; row += 2)
+  {
+    const auto *data = tileData + (row * 2);
+    auto low = _mm_set_epi64x(Broadcast(data[2]), Broadcast(data[0]));
+    auto high = _mm_set_epi64x(Broadcast(data[3]), Broadcast(data[1]));
+    auto bit1 =
+        _mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(low, mask), mask), one);
+    auto bit2 =
+        _mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(high, mask), mask), two);
+    _mm_storeu_si128(
+        reinterpret_cast<__m128i *>(colorIds + (row * DECODED_ROW_SIZE)),
+        _mm_or_si128(bit1, bit2));
+  }
+#else
+  for (std::size_t row{0}; row < TILE_ROWS; ++row)
+  {
+    DecodeTileRow(tileData[row * 2], tileData[(row * 2) + 1],
+        colorIds + (row * DECODED_ROW_SIZE));
+  }
+#endif
+}
+}  // namespace TileDecoder
@@ -7,13 +7,21 @@
 #include "logmanager.hpp"
 #include "mmu.hpp"
 
-Timer::Timer(MemoryManagementUnit &mmu) : _mmu(mmu)
+Timer::Timer(MemoryManagementUnit &mmu, Scheduler &scheduler)
+    : _mmu(mmu), _scheduler(scheduler), _state{.lastUpdate = scheduler.Now()}
 {
   _logger = LogManager::GetLogger("timer");
+  _scheduler.SetHandler(Scheduler::EventType::TimerOverflow, [this]() {
+    CatchUp();
+    ScheduleOverflow();
+  });
 }
 
-void Timer::Tick(int cycles)
+void Timer::CatchUp()
 {
+  auto now = _scheduler.Now();
+  auto cycles = now - _state.lastUpdate;
+  _state.lastUpdate = now;
   UpdateTimers(cycles);
 }
 
@@ -24,17 +32,20 @@ bool Timer::Contains(std::uint16_t addr) const
 
 std::uint8_t Timer::Read(std::uint16_t addr) const
 {
+  // registers have to be caught up before reading them, timer is never
+  // created const so casting it away is safe
+  const_cast<Timer *>(this)->CatchUp();
   if (addr == TIMA)
   {
-    return _tima;
+    return _state.tima;
   }
   else if (addr == TMA)
   {
-    return _tma;
+    return _state.tma;
   }
   else if (addr == TAC)
   {
-    return _tac;
+    return _state.tac;
   }
 
   LOG_TRACE(
@@ -44,94 +55,129 @@ std::uint8_t Timer::Read(std::uint16_t addr) const
 
 void Timer::Write(std::uint16_t addr, std::uint8_t data)
 {
+  // apply elapsed cycles with the old register values first
+  CatchUp();
   if (addr == DIV)
   {
-    _div = 0;
+    _state.div = 0;
     return;
   }
   else if (addr == TIMA)
   {
-    _tima = data;
+    _state.tima = data;
   }
   else if (addr == TMA)
   {
-    _tma = data;
+    _state.tma = data;
   }
   else if (addr == TAC)
   {
-    _tac = data;
+    _state.tac = data;
   }
-  LOG_TRACE(_logger, "Ignoring write to invalid address: {}", addr);
+  else
+  {
+    LOG_TRACE(_logger, "Ignoring write to invalid address: {}", addr);
+    return;
+  }
+  // TIMA and TAC change when the next overflow happens
+  ScheduleOverflow();
 }
 
 std::uint8_t &Timer::Address(std::uint16_t addr)
 {
+  CatchUp();
   if (addr == DIV)
   {
-    return _div;
+    return _state.div;
   }
   else if (addr == TIMA)
   {
-    return _tima;
+    return _state.tima;
   }
   else if (addr == TMA)
   {
-    return _tma;
+    return _state.tma;
   }
   else if (addr == TAC)
   {
-    return _tac;
+    return _state.tac;
   }
 
   // if address is not presesnt, return dummy value
   LOG_TRACE(
       _logger, "Trying to read invalid address: {}, returning 0xFF", addr);
-  static std::uint8_t dummy;
-  dummy = 0xFF;
-  return dummy;
+  _unmapped = 0xFF;
+  return _unmapped;
 }
 
-void Timer::UpdateDividerRegister(int cycles)
+void Timer::SaveState(SaveStateWriter &writer) const
 {
-  _dividerCounter += cycles;
-  while (_dividerCounter >= 256)
-  {
-    _dividerCounter -= 256;
-    ++_div;
-  }
+  writer.Write(_state);
 }
 
-void Timer::UpdateTimers(int cycles)
+void Timer::LoadState(SaveStateReader &reader)
+{
+  reader.Read(_state);
+}
+
+void Timer::UpdateDividerRegister(std::uint64_t cycles)
+{
+  _state.dividerCounter += cycles;
+  // DIV is 8 bits, so it wraps around
+  _state.div =
+      static_cast<std::uint8_t>(_state.div + (_state.dividerCounter / 256));
+  _state.dividerCounter %= 256;
+}
+
+void Timer::UpdateTimers(std::uint64_t cycles)
 {
   UpdateDividerRegister(cycles);
 
   // the clock must be enabled to update the clock
   if (IsClockEnabled())
   {
-    _timerCounter += cycles;
+    _state.timerCounter += cycles;
 
-    const int period = GetClockFreq();
+    const auto period = GetClockFreq();
     // Handle every TIMA tick that fits in the elapsed cycles, without
     // dropping leftover cycles (which would cause the timer to run slow).
-    while (_timerCounter >= period)
+    while (_state.timerCounter >= period)
     {
-      _timerCounter -= period;
-      if (_tima == 0xFF)
+      _state.timerCounter -= period;
+      if (_state.tima == 0xFF)
       {
-        _tima = _tma;
+        _state.tima = _state.tma;
         _mmu.RequestInterrupt(InterruptType::TIMER);
       }
       else
       {
-        ++_tima;
+        ++_state.tima;
       }
     }
   }
 }
 
-int Timer::GetClockFreq() const
+void Timer::ScheduleOverflow()
+{
+  if (!IsClockEnabled())
+  {
+    _scheduler.Cancel(Scheduler::EventType::TimerOverflow);
+    return;
+  }
+  // a TAC write that shortens the period can leave more than a whole new
+  // period in the counter, tick those off first so the overflow isn't due
+  // before the counter
+  UpdateTimers(0);
+  // TIMA overflows on the (0x100 - TIMA)th increment
+  auto cyclesToOverflow =
+      ((0x100U - _state.tima) * GetClockFreq()) - _state.timerCounter;
+  _scheduler.Schedule(Scheduler::EventType::TimerOverflow,
+      _state.lastUpdate + cyclesToOverflow);
+}
+
+std::uint64_t Timer::GetClockFreq() const
 {
-  auto freq = _tac & 0x03U;
+  auto freq = _state.tac & 0x03U;
   switch (freq)
   {
     case 0:
@@ -152,8 +198,7 @@ int Timer::GetClockFreq() const
   }
 }
 
-bool Timer::IsClockEnabled()
+bool Timer::IsClockEnabled() const
 {
-  constexpr uint16_t TAC{0xFF07U};
-  return (_mmu.Read(TAC) & (1U << 2U)) != 0;
+  return (_state.tac & (1U << 2U)) != 0;
 }
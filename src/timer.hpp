@@ -6,12 +6,16 @@
 
 #include "memoryrange.hpp"
 #include "mmu.hpp"
+#include "savestate.hpp"
+#include "scheduler.hpp"
 
 class Timer : public MemoryRange
 {
 public:
-  explicit Timer(MemoryManagementUnit &mmu);
-  void Tick(int cycles);
+  Timer(MemoryManagementUnit &mmu, Scheduler &scheduler);
+
+  // Bring timer registers up to date with the scheduler's current cycle
+  void CatchUp();
 
   [[nodiscard]]
   bool Contains(std::uint16_t addr) const override;
@@ -20,22 +24,38 @@ public:
   void Write(std::uint16_t addr, std::uint8_t data) override;
   std::uint8_t &Address(std::uint16_t addr) override;
 
+  void SaveState(SaveStateWriter &writer) const;
+  void LoadState(SaveStateReader &reader);
+
 private:
-  void UpdateDividerRegister(int cycles);
-  void UpdateTimers(int cycles);
+  void UpdateDividerRegister(std::uint64_t cycles);
+  void UpdateTimers(std::uint64_t cycles);
+  // Schedule TimerOverflow event for the cycle TIMA will overflow at
+  void ScheduleOverflow();
+  [[nodiscard]]
+  std::uint64_t GetClockFreq() const;
   [[nodiscard]]
-  int GetClockFreq() const;
-  bool IsClockEnabled();
+  bool IsClockEnabled() const;
 
-  MemoryManagementUnit &_mmu;
+  struct State
+  {
+    // cycle the timer was last caught up to
+    std::uint64_t lastUpdate{0};
+
+    std::uint64_t timerCounter{0};
+    std::uint64_t dividerCounter{0};
 
-  int _timerCounter{0};
-  int _dividerCounter{0};
+    std::uint8_t div{};
+    std::uint8_t tima{};
+    std::uint8_t tma{};
+    std::uint8_t tac{};
+  };
 
-  std::uint8_t _div{};
-  std::uint8_t _tima{};
-  std::uint8_t _tma{};
-  std::uint8_t _tac{};
+  MemoryManagementUnit &_mmu;
+  Scheduler &_scheduler;
+  State _state;
+  // handed out by Address for addresses that aren't timer registers
+  std::uint8_t _unmapped{0xFF};
 
   std::shared_ptr<spdlog::logger> _logger;
 };
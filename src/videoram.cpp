@@ -0,0 +1,61 @@
+#include "videoram.hpp"
+
+VideoRam::VideoRam() : ConcreteMemoryRange(VRAM_SIZE, VRAM_START_ADDRESS)
+{
+  _dirtyTiles.fill(true);
+}
+
+void VideoRam::Write(std::uint16_t addr, std::uint8_t data)
+{
+  ConcreteMemoryRange::Write(addr, data);
+  InvalidateTile(addr);
+}
+
+std::uint8_t &VideoRam::Address(std::uint16_t addr)
+{
+  InvalidateTile(addr);
+  return ConcreteMemoryRange::Address(addr);
+}
+
+MemoryRange::Storage VideoRam::GetStorage()
+{
+  auto storage = ConcreteMemoryRange::GetStorage();
+  storage.writable = false;
+  return storage;
+}
+
+void VideoRam::LoadState(SaveStateReader &reader)
+{
+  ConcreteMemoryRange::LoadState(reader);
+  _dirtyTiles.fill(true);
+}
+
+std::uint8_t VideoRam::ReadTileMap(std::uint16_t addr) const
+{
+  return ConcreteMemoryRange::Read(addr);
+}
+
+const std::uint8_t *VideoRam::GetTileRow(std::uint16_t addr)
+{
+  std::size_t tile = (addr - VRAM_START_ADDRESS) / TILE_DATA_SIZE;
+  auto *decodedTile = &_decodedTiles[tile * TileDecoder::DECODED_TILE_SIZE];
+  if (_dirtyTiles[tile])
+  {
+    const auto *tileData =
+        ConcreteMemoryRange::GetStorage().data + (tile * TILE_DATA_SIZE);
+    TileDecoder::DecodeTile(tileData, decodedTile);
+    _dirtyTiles[tile] = false;
+  }
+  // each row is 2 bytes in tile data
+  auto row = (addr % TILE_DATA_SIZE) / 2;
+  return decodedTile + (row * TileDecoder::DECODED_ROW_SIZE);
+}
+
+void VideoRam::InvalidateTile(std::uint16_t addr)
+{
+  // tile maps are not cached
+  if (addr >= VRAM_START_ADDRESS && addr < TILE_DATA_END_ADDRESS)
+  {
+    _dirtyTiles[(addr - VRAM_START_ADDRESS) / TILE_DATA_SIZE] = true;
+  }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "common.hpp"
+#include "concretememoryrange.hpp"
+#include "tiledecoder.hpp"
+
+// Video ram: 0x8000 - 0x9FFF, keeps the 384 tiles in tile data decoded to
+// color ids so the ppu doesn't have to decode bit planes on every fetch
+class VideoRam : public ConcreteMemoryRange
+{
+public:
+  VideoRam();
+
+  void Write(std::uint16_t addr, std::uint8_t data) override;
+
+  // caller may write through the reference, so the tile is invalidated
+  std::uint8_t &Address(std::uint16_t addr) override;
+
+  // Reads go straight to memory, writes must go through Write to invalidate
+  // decoded tiles
+  [[nodiscard]]
+  Storage GetStorage() override;
+
+  // every tile is decoded again after loading
+  void LoadState(SaveStateReader &reader) override;
+
+  // Tile index at addr in a tile map. The ppu reads vram itself, the bus
+  // lock of OAM DMA only cuts off the cpu
+  [[nodiscard]]
+  std::uint8_t ReadTileMap(std::uint16_t addr) const;
+
+  // Color ids of the 8 pixels of the tile row whose low byte is at addr,
+  // the tile is decoded again if it was written since it was last decoded
+  [[nodiscard]]
+  const std::uint8_t *GetTileRow(std::uint16_t addr);
+
+private:
+  void InvalidateTile(std::uint16_t addr);
+
+  std::array<std::uint8_t, TILE_COUNT * TileDecoder::DECODED_TILE_SIZE>
+      _decodedTiles{};
+  std::array<bool, TILE_COUNT> _dirtyTiles{};
+};
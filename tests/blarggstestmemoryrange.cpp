@@ -27,6 +27,12 @@ void BlarggsTestMemoryRange::Write(std::uint16_t addr, std::uint8_t data)
   }
 }
 
+[[nodiscard]]
+MemoryRange::Storage BlarggsTestMemoryRange::GetStorage()
+{
+  return {};
+}
+
 [[nodiscard]]
 bool BlarggsTestMemoryRange::IsTestPassed() const
 {
@@ -16,6 +16,10 @@ public:
 
   void Write(std::uint16_t addr, std::uint8_t data) override;
 
+  // Reads and writes are intercepted so storage can't be accessed directly
+  [[nodiscard]]
+  Storage GetStorage() override;
+
   [[nodiscard]]
   bool IsTestPassed() const;
 
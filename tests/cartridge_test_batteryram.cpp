@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "cartridge.hpp"
+#include "common/testroms.hpp"
+#include "mmu.hpp"
+#include "scheduler.hpp"
+
+namespace
+{
+std::vector<std::uint8_t> ReadFile(const std::filesystem::path &path)
+{
+  std::ifstream file{path, std::ios::binary};
+  return {std::istreambuf_iterator<char>{file}, {}};
+}
+}  // namespace
+
+TEST(CARTRIDGE_BATTERY_RAM, RAM_IS_KEPT_IN_SAVE_FILE)
+{
+  auto path = std::filesystem::temp_directory_path()
+              / std::format("noobboy_test_{}.sav", std::random_device{}());
+  auto rom = OpenBankedRom(4, 0x03, 0x03);
+  {
+    MemoryManagementUnit mmu;
+    Scheduler scheduler;
+    auto cartridge = std::make_shared<Cartridge>(mmu, scheduler, rom);
+    mmu.AddMemoryRange(cartridge);
+    cartridge->MapBanks();
+    ASSERT_TRUE(cartridge->UseSaveFile(path.string()));
+    EXPECT_EQ(std::filesystem::file_size(path), 0x8000U);
+
+    mmu.Write(0x0000, 0x0A);
+    mmu.Write(0x6000, 0x01);
+    mmu.Write(0x4000, 0x03);
+    mmu.Write(0xA123, 0x42);
+    // the ram is the file, it's there before any flush
+    EXPECT_EQ(ReadFile(path)[0x6123], 0x42);
+    cartridge->FlushSaveFile();
+  }
+
+  MemoryManagementUnit mmu;
+  Scheduler scheduler;
+  auto cartridge = std::make_shared<Cartridge>(mmu, scheduler, rom);
+  mmu.AddMemoryRange(cartridge);
+  cartridge->MapBanks();
+  ASSERT_TRUE(cartridge->UseSaveFile(path.string()));
+  mmu.Write(0x0000, 0x0A);
+  mmu.Write(0x6000, 0x01);
+  mmu.Write(0x4000, 0x03);
+  EXPECT_EQ(mmu.Read(0xA123), 0x42);
+  cartridge.reset();
+  std::filesystem::remove(path);
+}
+
+TEST(CARTRIDGE_BATTERY_RAM, SHORT_FILES_ARE_GROWN)
+{
+  auto path = std::filesystem::temp_directory_path()
+              / std::format("noobboy_test_{}.sav", std::random_device{}());
+  WriteFile(path, {0x12, 0x34});
+  {
+    MemoryManagementUnit mmu;
+    Scheduler scheduler;
+    auto cartridge = std::make_shared<Cartridge>(
+        mmu, scheduler, OpenBankedRom(2, 0x09, 0x02));
+    mmu.AddMemoryRange(cartridge);
+    cartridge->MapBanks();
+    ASSERT_TRUE(cartridge->UseSaveFile(path.string()));
+    EXPECT_EQ(mmu.Read(0xA001), 0x34);
+    EXPECT_EQ(mmu.Read(0xA002), 0x00);
+  }
+  EXPECT_EQ(std::filesystem::file_size(path), 0x2000U);
+  std::filesystem::remove(path);
+}
+
+TEST(CARTRIDGE_BATTERY_RAM, NO_SAVE_FILE_WITHOUT_BATTERY)
+{
+  auto path = std::filesystem::temp_directory_path()
+              / std::format("noobboy_test_{}.sav", std::random_device{}());
+  MemoryManagementUnit mmu;
+  Scheduler scheduler;
+  Cartridge withoutBattery{mmu, scheduler, OpenBankedRom(2, 0x02, 0x02)};
+  EXPECT_FALSE(withoutBattery.UseSaveFile(path.string()));
+  Cartridge withoutRam{mmu, scheduler, OpenBankedRom(2, 0x03, 0x00)};
+  EXPECT_FALSE(withoutRam.UseSaveFile(path.string()));
+  EXPECT_FALSE(std::filesystem::exists(path));
+}
+
+TEST(CARTRIDGE_BATTERY_RAM, CLOCK_IS_KEPT_IN_SAVE_FILE)
+{
+  auto path = std::filesystem::temp_directory_path()
+              / std::format("noobboy_test_{}.sav", std::random_device{}());
+  // MBC3 with a clock and battery but no ram
+  auto rom = OpenBankedRom(2, 0x0F, 0x00);
+  auto selectClock = [](MemoryManagementUnit &mmu, std::uint8_t reg) {
+    mmu.Write(0x4000, reg);
+  };
+  {
+    MemoryManagementUnit mmu;
+    Scheduler scheduler;
+    auto cartridge = std::make_shared<Cartridge>(mmu, scheduler, rom);
+    mmu.AddMemoryRange(cartridge);
+    cartridge->MapBanks();
+    ASSERT_TRUE(cartridge->UseSaveFile(path.string()));
+    EXPECT_EQ(std::filesystem::file_size(path), 48U);
+
+    // halted at 0:12:34, so it doesn't run on while off
+    mmu.Write(0x0000, 0x0A);
+    selectClock(mmu, 0x0C);
+    mmu.Write(0xA000, 0x40);
+    selectClock(mmu, 0x08);
+    mmu.Write(0xA000, 34);
+    selectClock(mmu, 0x09);
+    mmu.Write(0xA000, 12);
+    cartridge->FlushSaveFile();
+  }
+
+  MemoryManagementUnit mmu;
+  Scheduler scheduler;
+  auto cartridge = std::make_shared<Cartridge>(mmu, scheduler, rom);
+  mmu.AddMemoryRange(cartridge);
+  cartridge->MapBanks();
+  ASSERT_TRUE(cartridge->UseSaveFile(path.string()));
+  mmu.Write(0x0000, 0x0A);
+  mmu.Write(0x6000, 0x00);
+  mmu.Write(0x6000, 0x01);
+  selectClock(mmu, 0x08);
+  EXPECT_EQ(mmu.Read(0xA000), 34);
+  selectClock(mmu, 0x09);
+  EXPECT_EQ(mmu.Read(0xA000), 12);
+  selectClock(mmu, 0x0C);
+  EXPECT_EQ(mmu.Read(0xA000), 0x40);
+  cartridge.reset();
+  std::filesystem::remove(path);
+}
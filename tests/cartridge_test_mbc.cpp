@@ -0,0 +1,210 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "cartridge.hpp"
+#include "common/cpurun.hpp"
+#include "common/testroms.hpp"
+#include "mmu.hpp"
+#include "savestate.hpp"
+#include "scheduler.hpp"
+
+namespace
+{
+constexpr int CYCLES_PER_SECOND{4194304};
+
+struct CartridgeBus
+{
+  CartridgeBus(std::size_t bankCount, std::uint8_t type,
+      std::uint8_t ramSizeCode = 0)
+      : cartridge{std::make_shared<Cartridge>(
+            mmu, scheduler, OpenBankedRom(bankCount, type, ramSizeCode))}
+  {
+    mmu.AddMemoryRange(cartridge);
+    cartridge->MapBanks();
+  }
+
+  [[nodiscard]]
+  unsigned int BankAt(std::uint16_t addr) const
+  {
+    return mmu.Read(addr) | (mmu.Read(addr + 1) << 8U);
+  }
+
+  void AdvanceSeconds(int seconds)
+  {
+    for (int second{0}; second < seconds; ++second)
+    {
+      scheduler.Advance(CYCLES_PER_SECOND);
+    }
+  }
+
+  MemoryManagementUnit mmu;
+  Scheduler scheduler;
+  std::shared_ptr<Cartridge> cartridge;
+};
+}  // namespace
+
+TEST(CARTRIDGE_MBC, MBC1_SWITCHES_ROM_BANKS)
+{
+  CartridgeBus bus{128, 0x01};
+  EXPECT_EQ(bus.cartridge->GetMbc(), Cartridge::Mbc::Mbc1);
+  EXPECT_EQ(bus.BankAt(0x4000), 1U);
+
+  bus.mmu.Write(0x2000, 0x05);
+  EXPECT_EQ(bus.BankAt(0x4000), 5U);
+  // bank 0 selects bank 1, also with the upper bits set
+  bus.mmu.Write(0x2000, 0x00);
+  EXPECT_EQ(bus.BankAt(0x4000), 1U);
+  bus.mmu.Write(0x4000, 0x01);
+  EXPECT_EQ(bus.BankAt(0x4000), 0x21U);
+  EXPECT_EQ(bus.BankAt(0x0000), 0U);
+
+  // mode 1 banks 0x0000 - 0x3FFF with the upper bits too
+  bus.mmu.Write(0x6000, 0x01);
+  EXPECT_EQ(bus.BankAt(0x0000), 0x20U);
+  EXPECT_EQ(bus.BankAt(0x4000), 0x21U);
+  bus.mmu.Write(0x2000, 0x03);
+  EXPECT_EQ(bus.BankAt(0x4000), 0x23U);
+}
+
+TEST(CARTRIDGE_MBC, READ_MODIFY_WRITE_REACHES_MAPPER)
+{
+  // LD HL,0x2000; SET 2,(HL)
+  CpuRun run{0x21, 0x00, 0x20, 0xCB, 0xD6};
+  auto cartridge = std::make_shared<Cartridge>(
+      run.mmu, run.scheduler, OpenBankedRom(8, 0x01, 0));
+  run.mmu.AddMemoryRange(cartridge);
+  cartridge->MapBanks();
+
+  // rom reads 0x00 at 0x2000, the write selects bank 4
+  run.Step(2);
+  EXPECT_EQ(run.mmu.Read(0x4000), 4);
+}
+
+TEST(CARTRIDGE_MBC, MBC1_BANKS_RAM)
+{
+  CartridgeBus bus{4, 0x03, 0x03};
+  EXPECT_EQ(bus.mmu.Read(0xA000), 0xFF);
+  bus.mmu.Write(0xA000, 0x11);
+  EXPECT_EQ(bus.mmu.Read(0xA000), 0xFF);
+
+  bus.mmu.Write(0x0000, 0x0A);
+  bus.mmu.Write(0xA000, 0x11);
+  bus.mmu.Write(0x6000, 0x01);
+  bus.mmu.Write(0x4000, 0x02);
+  EXPECT_EQ(bus.mmu.Read(0xA000), 0x00);
+  bus.mmu.Write(0xA000, 0x22);
+  bus.mmu.Write(0x4000, 0x00);
+  EXPECT_EQ(bus.mmu.Read(0xA000), 0x11);
+  bus.mmu.Write(0x4000, 0x02);
+  EXPECT_EQ(bus.mmu.Read(0xA000), 0x22);
+
+  bus.mmu.Write(0x0000, 0x00);
+  EXPECT_EQ(bus.mmu.Read(0xA000), 0xFF);
+}
+
+TEST(CARTRIDGE_MBC, MBC3_CLOCK_COUNTS_EMULATED_TIME)
+{
+  CartridgeBus bus{8, 0x10, 0x03};
+  bus.mmu.Write(0x0000, 0x0A);
+  bus.mmu.Write(0x2000, 0x07);
+  EXPECT_EQ(bus.BankAt(0x4000), 7U);
+
+  auto latch = [&bus] {
+    bus.mmu.Write(0x6000, 0x00);
+    bus.mmu.Write(0x6000, 0x01);
+  };
+  auto read = [&bus](std::uint8_t rtcRegister) {
+    bus.mmu.Write(0x4000, rtcRegister);
+    return bus.mmu.Read(0xA000);
+  };
+
+  bus.AdvanceSeconds(3661);
+  EXPECT_EQ(read(0x08), 0);
+  latch();
+  EXPECT_EQ(read(0x08), 1);
+  EXPECT_EQ(read(0x09), 1);
+  EXPECT_EQ(read(0x0A), 1);
+
+  // halted clock doesn't count
+  bus.mmu.Write(0x4000, 0x0C);
+  bus.mmu.Write(0xA000, 0x40);
+  bus.AdvanceSeconds(10);
+  latch();
+  EXPECT_EQ(read(0x08), 1);
+
+  // last second of day 511 overflows into the carry bit
+  bus.mmu.Write(0x4000, 0x08);
+  bus.mmu.Write(0xA000, 59);
+  bus.mmu.Write(0x4000, 0x09);
+  bus.mmu.Write(0xA000, 59);
+  bus.mmu.Write(0x4000, 0x0A);
+  bus.mmu.Write(0xA000, 23);
+  bus.mmu.Write(0x4000, 0x0B);
+  bus.mmu.Write(0xA000, 0xFF);
+  bus.mmu.Write(0x4000, 0x0C);
+  bus.mmu.Write(0xA000, 0x01);
+  bus.AdvanceSeconds(1);
+  latch();
+  EXPECT_EQ(read(0x08), 0);
+  EXPECT_EQ(read(0x0A), 0);
+  EXPECT_EQ(read(0x0B), 0);
+  EXPECT_EQ(read(0x0C), 0x80);
+
+  // ram is still there next to the clock
+  bus.mmu.Write(0x4000, 0x01);
+  bus.mmu.Write(0xA000, 0x33);
+  bus.mmu.Write(0x4000, 0x00);
+  EXPECT_EQ(bus.mmu.Read(0xA000), 0x00);
+  bus.mmu.Write(0x4000, 0x01);
+  EXPECT_EQ(bus.mmu.Read(0xA000), 0x33);
+}
+
+TEST(CARTRIDGE_MBC, MBC5_SWITCHES_NINE_BIT_BANKS)
+{
+  CartridgeBus bus{512, 0x1B, 0x04};
+  bus.mmu.Write(0x2000, 0x01);
+  bus.mmu.Write(0x3000, 0x01);
+  EXPECT_EQ(bus.BankAt(0x4000), 0x101U);
+  // bank 0 can be selected
+  bus.mmu.Write(0x2000, 0x00);
+  bus.mmu.Write(0x3000, 0x00);
+  EXPECT_EQ(bus.BankAt(0x4000), 0U);
+
+  bus.mmu.Write(0x2000, 0x42);
+  bus.mmu.Write(0x0000, 0x0A);
+  bus.mmu.Write(0x4000, 0x0F);
+  bus.mmu.Write(0xBFFF, 0x55);
+
+  std::vector<std::uint8_t> state;
+  SaveStateWriter writer{state};
+  bus.cartridge->SaveState(writer);
+
+  bus.mmu.Write(0x2000, 0x10);
+  bus.mmu.Write(0x4000, 0x00);
+  bus.mmu.Write(0xBFFF, 0x66);
+
+  SaveStateReader reader{state};
+  bus.cartridge->LoadState(reader);
+  EXPECT_EQ(bus.BankAt(0x4000), 0x42U);
+  EXPECT_EQ(bus.mmu.Read(0xBFFF), 0x55);
+  bus.mmu.Write(0x4000, 0x00);
+  EXPECT_EQ(bus.mmu.Read(0xBFFF), 0x00);
+}
+
+TEST(CARTRIDGE_MBC, REJECTS_UNSUPPORTED_CARTRIDGES)
+{
+  MemoryManagementUnit mmu;
+  Scheduler scheduler;
+  // MBC2
+  EXPECT_THROW(Cartridge(mmu, scheduler, OpenBankedRom(2, 0x05, 0)),
+      std::runtime_error);
+  EXPECT_THROW(Cartridge(mmu, scheduler, OpenBankedRom(2, 0x00, 0x09)),
+      std::runtime_error);
+  EXPECT_THROW(Cartridge(mmu, scheduler, OpenBankedRom(1, 0x00, 0)),
+      std::runtime_error);
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <span>
+
+#include "concretememoryrange.hpp"
+#include "cpu.hpp"
+#include "mmu.hpp"
+#include "scheduler.hpp"
+
+// A cpu running a program loaded into work ram, with its stack there too.
+// Tests add the memory ranges the program accesses besides work ram
+
+inline constexpr std::uint16_t CPU_RUN_PROGRAM_ADDRESS{0xC000};
+inline constexpr std::uint16_t CPU_RUN_STACK_ADDRESS{0xD000};
+
+struct CpuRun
+{
+  explicit CpuRun(std::initializer_list<std::uint8_t> program)
+      : CpuRun(std::span<const std::uint8_t>{program.begin(), program.size()})
+  {
+  }
+
+  explicit CpuRun(std::span<const std::uint8_t> program)
+  {
+    mmu.AddMemoryRange(std::make_shared<ConcreteMemoryRange>(0x2000, 0xC000));
+    std::uint16_t addr{CPU_RUN_PROGRAM_ADDRESS};
+    for (auto opcode : program)
+    {
+      mmu.Write(addr++, opcode);
+    }
+    CpuState state{};
+    state.PC.reg = CPU_RUN_PROGRAM_ADDRESS;
+    state.SP.reg = CPU_RUN_STACK_ADDRESS;
+    cpu = std::make_unique<Cpu>(state, mmu);
+  }
+
+  // Run instructions one Tick at a time, advancing the scheduler
+  void Step(int instructions)
+  {
+    for (int instruction{0}; instruction < instructions; ++instruction)
+    {
+      scheduler.Advance(cpu->Tick());
+    }
+  }
+
+  [[nodiscard]]
+  CpuState State() const
+  {
+    return cpu->GetCpuState();
+  }
+
+  MemoryManagementUnit mmu;
+  Scheduler scheduler;
+  std::unique_ptr<Cpu> cpu;
+};
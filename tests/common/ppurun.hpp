@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "common.hpp"
+#include "memorydisplay.hpp"
+#include "mmu.hpp"
+#include "ppu.hpp"
+#include "scheduler.hpp"
+#include "videoram.hpp"
+
+// A ppu on its own bus with vram, stepped one dot at a time, for tests that
+// compare the render modes or check the pixels of a frame
+
+inline constexpr int PPU_RUN_DOTS_PER_FRAME{456 * 154};
+inline constexpr std::uint8_t PPU_RUN_BGP{0xE4};
+inline constexpr std::uint8_t PPU_RUN_OBP0{0xE4};
+inline constexpr std::uint8_t PPU_RUN_OBP1{0x1B};
+
+struct PpuRun
+{
+  explicit PpuRun(Ppu::RenderMode renderMode)
+      : ppu{std::make_shared<Ppu>(mmu, *vram, display, scheduler, renderMode)}
+  {
+    mmu.AddMemoryRange(vram);
+    mmu.AddMemoryRange(ppu);
+    mmu.Write(BGP_REGISTER_ADDRESS, PPU_RUN_BGP);
+    mmu.Write(OBP0_REGISTER_ADDRESS, PPU_RUN_OBP0);
+    mmu.Write(OBP1_REGISTER_ADDRESS, PPU_RUN_OBP1);
+  }
+
+  void SetSprite(std::size_t index, std::uint8_t y, std::uint8_t x,
+      std::uint8_t tile, std::uint8_t flags)
+  {
+    auto addr = static_cast<std::uint16_t>(OAM_START_ADDRESS + (index * 4));
+    mmu.Write(addr, y);
+    mmu.Write(static_cast<std::uint16_t>(addr + 1), x);
+    mmu.Write(static_cast<std::uint16_t>(addr + 2), tile);
+    mmu.Write(static_cast<std::uint16_t>(addr + 3), flags);
+  }
+
+  // Run two frames, LY and STAT are sampled every dot. onDot runs before
+  // every dot, for register writes in the middle of a frame
+  template <typename OnDot>
+  void Run(OnDot onDot)
+  {
+    for (int dots{0}; dots < 2 * PPU_RUN_DOTS_PER_FRAME; ++dots)
+    {
+      onDot();
+      scheduler.Advance(1);
+      if (scheduler.IsEventDue())
+      {
+        scheduler.RunDueEvents();
+      }
+      timeline.push_back(mmu.Read(LY_REGISTER_ADDRESS));
+      timeline.push_back(mmu.Read(LCD_STAT_REGISTER_ADDRESS));
+    }
+  }
+
+  void Run()
+  {
+    Run([]() {});
+  }
+
+  [[nodiscard]]
+  std::uint8_t Pixel(unsigned int x, unsigned int y) const
+  {
+    return display.GetFramebuffer()[(y * SCREEN_WIDTH) + x];
+  }
+
+  MemoryManagementUnit mmu;
+  Scheduler scheduler;
+  MemoryDisplay display{false};
+  std::shared_ptr<VideoRam> vram{std::make_shared<VideoRam>()};
+  std::shared_ptr<Ppu> ppu;
+  std::vector<std::uint8_t> timeline;
+};
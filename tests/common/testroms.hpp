@@ -0,0 +1,172 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "cartridge.hpp"
+#include "machine.hpp"
+#include "memorydisplay.hpp"
+#include "romimage.hpp"
+
+// Bootrom and rom for tests that run a whole machine
+
+inline constexpr std::size_t BOOT_ROM_SIZE{0x100};
+inline constexpr std::size_t ROM_SIZE{0x8000};
+inline constexpr std::size_t ENTRY_POINT{0x100};
+
+// Bootrom that only unmaps itself, execution falls through to 0x100
+inline const std::vector<std::uint8_t> BOOT_ROM_END{
+    0x3E, 0x01,  // LD A, 0x01
+    0xE0, 0x50,  // LDH (0x50), A
+};
+
+// Enables the timer, then keeps writing a counter all over vram and into
+// SCX so every frame differs from the one before
+inline const std::vector<std::uint8_t> PROGRAM{
+    0x3E, 0xE4,        // LD A, 0xE4
+    0xE0, 0x47,        // LDH (BGP), A
+    0x3E, 0x05,        // LD A, 0x05
+    0xE0, 0x07,        // LDH (TAC), A
+    0x21, 0x00, 0x80,  // LD HL, 0x8000
+    0x04,              // loop: INC B
+    0x78,              // LD A, B
+    0x22,              // LD (HL+), A
+    0x7C,              // LD A, H
+    0xE6, 0x1F,        // AND 0x1F
+    0xF6, 0x80,        // OR 0x80
+    0x67,              // LD H, A
+    0x78,              // LD A, B
+    0xE0, 0x43,        // LDH (SCX), A
+    0x18, 0xF2,        // JR loop
+};
+
+// Reads the d-pad every loop and adds it to the counter written to vram and
+// SCX, so frames depend on every button pressed so far
+inline const std::vector<std::uint8_t> JOYPAD_PROGRAM{
+    0x3E, 0xE4,        // LD A, 0xE4
+    0xE0, 0x47,        // LDH (BGP), A
+    0x21, 0x00, 0x80,  // LD HL, 0x8000
+    0x3E, 0x20,        // loop: LD A, 0x20
+    0xE0, 0x00,        // LDH (P1), A
+    0xF0, 0x00,        // LDH A, (P1)
+    0x80,              // ADD A, B
+    0x47,              // LD B, A
+    0x22,              // LD (HL+), A
+    0x7C,              // LD A, H
+    0xE6, 0x1F,        // AND 0x1F
+    0xF6, 0x80,        // OR 0x80
+    0x67,              // LD H, A
+    0x78,              // LD A, B
+    0xE0, 0x43,        // LDH (SCX), A
+    0x18, 0xEC,        // JR loop
+};
+
+// Sleeps in HALT with interrupts disabled until the next vblank, then writes
+// a counter and LY into tile 0, so every frame differs from the one before
+inline const std::vector<std::uint8_t> HALT_PROGRAM{
+    0x3E, 0x91,        // LD A, 0x91
+    0xE0, 0x40,        // LDH (LCDC), A
+    0x3E, 0xE4,        // LD A, 0xE4
+    0xE0, 0x47,        // LDH (BGP), A
+    0x3E, 0x01,        // LD A, 0x01
+    0xE0, 0xFF,        // LDH (IE), A
+    0xAF,              // loop: XOR A
+    0xE0, 0x0F,        // LDH (IF), A
+    0x76,              // HALT
+    0x04,              // INC B
+    0x78,              // LD A, B
+    0xEA, 0x00, 0x80,  // LD (0x8000), A
+    0xF0, 0x44,        // LDH A, (LY)
+    0xEA, 0x01, 0x80,  // LD (0x8001), A
+    0x18, 0xF0,        // JR loop
+};
+
+inline void WriteFile(const std::filesystem::path &path,
+    const std::vector<std::uint8_t> &data)
+{
+  std::ofstream file{path, std::ios::binary};
+  file.write(reinterpret_cast<const char *>(data.data()),
+      static_cast<std::streamsize>(data.size()));
+}
+
+// Writes the bootrom and rom above to temporary files for a machine to load
+struct TestRoms
+{
+  explicit TestRoms(const std::vector<std::uint8_t> &program = PROGRAM)
+  {
+    // tests may run in parallel, every instance gets its own files
+    auto dir = std::filesystem::temp_directory_path();
+    auto id = std::random_device{}();
+    bootRomPath = (dir / std::format("noobboy_test_boot_{}.bin", id)).string();
+    romPath = (dir / std::format("noobboy_test_rom_{}.gb", id)).string();
+
+    std::vector<std::uint8_t> bootRom(BOOT_ROM_SIZE, 0x00);
+    std::copy(BOOT_ROM_END.begin(), BOOT_ROM_END.end(),
+        bootRom.end() - static_cast<std::ptrdiff_t>(BOOT_ROM_END.size()));
+    WriteFile(bootRomPath, bootRom);
+
+    std::vector<std::uint8_t> rom(ROM_SIZE, 0x00);
+    std::copy(program.begin(), program.end(),
+        rom.begin() + static_cast<std::ptrdiff_t>(ENTRY_POINT));
+    WriteFile(romPath, rom);
+  }
+
+  TestRoms(const TestRoms &) = delete;
+  TestRoms &operator=(const TestRoms &) = delete;
+  TestRoms(TestRoms &&) = delete;
+  TestRoms &operator=(TestRoms &&) = delete;
+
+  ~TestRoms()
+  {
+    std::filesystem::remove(bootRomPath);
+    std::filesystem::remove(romPath);
+  }
+
+  std::string bootRomPath;
+  std::string romPath;
+};
+
+// Run frames and return the hash of each, display must hash frames
+inline std::vector<std::uint64_t> RunFrames(
+    Machine &machine, MemoryDisplay &display, int frames)
+{
+  std::vector<std::uint64_t> hashes;
+  for (int frame{0}; frame < frames; ++frame)
+  {
+    machine.RunFrame();
+    hashes.push_back(display.GetFrameHash());
+  }
+  return hashes;
+}
+
+// Rom of bankCount banks that start with their own bank number (low byte,
+// then high byte), with a header asking for type and ramSizeCode
+inline std::shared_ptr<const RomImage> OpenBankedRom(
+    std::size_t bankCount, std::uint8_t type, std::uint8_t ramSizeCode)
+{
+  std::vector<std::uint8_t> rom(bankCount * Cartridge::ROM_BANK_SIZE);
+  for (std::size_t bank{0}; bank < bankCount; ++bank)
+  {
+    rom[bank * Cartridge::ROM_BANK_SIZE] = static_cast<std::uint8_t>(bank);
+    rom[bank * Cartridge::ROM_BANK_SIZE + 1] =
+        static_cast<std::uint8_t>(bank >> 8U);
+  }
+  rom[0x0147] = type;
+  rom[0x0149] = ramSizeCode;
+
+  // the mapping outlives the file
+  auto path = std::filesystem::temp_directory_path()
+              / std::format("noobboy_test_{}.gb", std::random_device{}());
+  WriteFile(path, rom);
+  auto image = RomImage::Open(path.string());
+  std::filesystem::remove(path);
+  return image;
+}
@@ -7,6 +7,7 @@
 #include "blarggstestmemoryrange.hpp"
 #include "cpu.hpp"
 #include "mmu.hpp"
+#include "scheduler.hpp"
 #include "timer.hpp"
 
 static void TestInstructionBlarggs(std::string romPath)
@@ -17,7 +18,8 @@ static void TestInstructionBlarggs(std::string romPath)
   ASSERT_TRUE(file.is_open());
 
   MemoryManagementUnit mmu;
-  auto timer = std::make_shared<Timer>(mmu);
+  Scheduler scheduler;
+  auto timer = std::make_shared<Timer>(mmu, scheduler);
   mmu.AddMemoryRange(timer);
 
   auto mr = std::make_shared<BlarggsTestMemoryRange>(0x10000, 0x00);
@@ -43,8 +45,11 @@ static void TestInstructionBlarggs(std::string romPath)
   Cpu cpu(state, mmu);
   while (!mr->IsTestCompleted())
   {
-    int cycles = cpu.Tick();
-    timer->Tick(cycles);
+    scheduler.Advance(cpu.Tick());
+    if (scheduler.IsEventDue())
+    {
+      scheduler.RunDueEvents();
+    }
   }
 
   EXPECT_EQ(true, mr->IsTestPassed()) << mr->GetMessage();
@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "common/cpurun.hpp"
+#include "savestate.hpp"
+
+namespace
+{
+constexpr std::uint8_t FLAG_Z{0x80};
+constexpr std::uint8_t FLAG_N{0x40};
+constexpr std::uint8_t FLAG_H{0x20};
+constexpr std::uint8_t FLAG_C{0x10};
+
+std::uint8_t Flags(const CpuRun &run)
+{
+  return run.State().AF.low;
+}
+}  // namespace
+
+TEST(CPU_FLAGS, ALU_FLAGS_ARE_VISIBLE_IN_STATE)
+{
+  // LD A,0x10; SUB 0x20; INC A; AND 0x0F; XOR A; LD A,0x0F; ADD A,0x01
+  CpuRun run{0x3E, 0x10, 0xD6, 0x20, 0x3C, 0xE6, 0x0F, 0xAF, 0x3E, 0x0F, 0xC6,
+      0x01};
+  run.Step(2);
+  EXPECT_EQ(run.State().AF.high, 0xF0);
+  EXPECT_EQ(Flags(run), FLAG_N | FLAG_C);
+  // INC keeps the carry of the SUB
+  run.Step(1);
+  EXPECT_EQ(Flags(run), FLAG_C);
+  run.Step(1);
+  EXPECT_EQ(Flags(run), FLAG_H);
+  run.Step(1);
+  EXPECT_EQ(Flags(run), FLAG_Z);
+  run.Step(2);
+  EXPECT_EQ(run.State().AF.high, 0x10);
+  EXPECT_EQ(Flags(run), FLAG_H);
+}
+
+TEST(CPU_FLAGS, CONDITIONS_AND_PUSH_SEE_DEFERRED_FLAGS)
+{
+  // LD A,0x01; DEC A; JR NZ,+2; PUSH AF; POP BC
+  CpuRun run{0x3E, 0x01, 0x3D, 0x20, 0x02, 0xF5, 0xC1};
+  run.Step(3);
+  EXPECT_EQ(run.State().PC.reg, CPU_RUN_PROGRAM_ADDRESS + 5);
+  run.Step(2);
+  EXPECT_EQ(run.State().BC.low, FLAG_Z | FLAG_N);
+}
+
+TEST(CPU_FLAGS, SAVE_STATE_KEEPS_DEFERRED_FLAGS)
+{
+  // LD A,0xFF; ADD A,0x01; SCF
+  CpuRun run{0x3E, 0xFF, 0xC6, 0x01, 0x37};
+  run.Step(2);
+
+  std::vector<std::uint8_t> state;
+  SaveStateWriter writer{state};
+  run.cpu->SaveState(writer);
+
+  run.Step(1);
+  EXPECT_EQ(Flags(run), FLAG_Z | FLAG_C);
+
+  SaveStateReader reader{state};
+  run.cpu->LoadState(reader);
+  EXPECT_EQ(Flags(run), FLAG_Z | FLAG_H | FLAG_C);
+}
@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+
+#include "common/cpurun.hpp"
+#include "concretememoryrange.hpp"
+#include "scheduler.hpp"
+
+namespace
+{
+constexpr std::uint16_t TIMER_INTERRUPT_ADDRESS{0x0050};
+
+std::uint16_t PC(const CpuRun &run)
+{
+  return run.State().PC.reg;
+}
+}  // namespace
+
+TEST(CPU_INTERRUPT_CHECK, STOPS_AFTER_MEMORY_WRITES)
+{
+  // NOP; NOP; LD (HL),A; NOP; CB RES 0,(HL); NOP
+  CpuRun run{0x00, 0x00, 0x77, 0x00, 0xCB, 0x86, 0x00};
+  // HL is 0x0000
+  run.mmu.AddMemoryRange(std::make_shared<ConcreteMemoryRange>(0x100, 0x0000));
+  run.cpu->RunUntilInterruptCheck(run.scheduler);
+  EXPECT_EQ(PC(run), CPU_RUN_PROGRAM_ADDRESS + 3);
+  EXPECT_EQ(run.scheduler.Now(), 16U);
+  run.cpu->RunUntilInterruptCheck(run.scheduler);
+  EXPECT_EQ(PC(run), CPU_RUN_PROGRAM_ADDRESS + 6);
+}
+
+TEST(CPU_INTERRUPT_CHECK, STOPS_WHEN_EVENT_IS_DUE)
+{
+  CpuRun run{0x00, 0x00, 0x00, 0x00};
+  run.scheduler.SetHandler(Scheduler::EventType::PpuModeChange, [] {});
+  run.scheduler.Schedule(Scheduler::EventType::PpuModeChange, 8);
+  run.cpu->RunUntilInterruptCheck(run.scheduler);
+  EXPECT_EQ(PC(run), CPU_RUN_PROGRAM_ADDRESS + 2);
+}
+
+TEST(CPU_INTERRUPT_CHECK, TAKES_INTERRUPT_AFTER_THE_WRITE_REQUESTING_IT)
+{
+  // EI; LD A,0x04; LDH (IE),A; LDH (IF),A; NOP
+  CpuRun run{0xFB, 0x3E, 0x04, 0xE0, 0xFF, 0xE0, 0x0F, 0x00};
+  run.mmu.AddMemoryRange(std::make_shared<ConcreteMemoryRange>(0x100, 0x0000));
+  // LD (HL),A in the handler stops the run there
+  run.mmu.Write(TIMER_INTERRUPT_ADDRESS, 0x77);
+  for (int check{0}; check < 3; ++check)
+  {
+    run.cpu->RunUntilInterruptCheck(run.scheduler);
+  }
+  EXPECT_EQ(PC(run), CPU_RUN_PROGRAM_ADDRESS + 7);
+
+  // the NOP after the write isn't run before the interrupt is taken
+  run.cpu->RunUntilInterruptCheck(run.scheduler);
+  EXPECT_EQ(PC(run), TIMER_INTERRUPT_ADDRESS + 1);
+  EXPECT_EQ(run.mmu.Read(CPU_RUN_STACK_ADDRESS - 2),
+      (CPU_RUN_PROGRAM_ADDRESS + 7) & 0xFF);
+}
@@ -0,0 +1,48 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+
+#include "common.hpp"
+#include "memorydisplay.hpp"
+
+namespace
+{
+void DrawFrame(MemoryDisplay &display, std::uint8_t firstShade)
+{
+  std::array<std::uint8_t, SCREEN_WIDTH> line{};
+  for (unsigned int ly{0}; ly < MemoryDisplay::LCD_HEIGHT; ++ly)
+  {
+    for (unsigned int x{0}; x < SCREEN_WIDTH; ++x)
+    {
+      line[x] = static_cast<std::uint8_t>((firstShade + x + ly) & 0x3U);
+    }
+    display.DrawLine(ly, line);
+  }
+  display.UpdateFrame();
+}
+}  // namespace
+
+TEST(DISPLAY_MEMORY_DISPLAY, KEEPS_FRAME)
+{
+  MemoryDisplay display{false};
+  DrawFrame(display, 1);
+  auto framebuffer = display.GetFramebuffer();
+  ASSERT_EQ(framebuffer.size(), SCREEN_WIDTH * MemoryDisplay::LCD_HEIGHT);
+  EXPECT_EQ(framebuffer[0], 1);
+  EXPECT_EQ(framebuffer[1], 2);
+  EXPECT_EQ(framebuffer[SCREEN_WIDTH], 2);
+  EXPECT_EQ(display.GetFrameHash(), 0U);
+}
+
+TEST(DISPLAY_MEMORY_DISPLAY, HASHES_FRAMES)
+{
+  MemoryDisplay display{true};
+  DrawFrame(display, 0);
+  auto first = display.GetFrameHash();
+  DrawFrame(display, 2);
+  auto second = display.GetFrameHash();
+  DrawFrame(display, 0);
+  EXPECT_NE(first, second);
+  EXPECT_EQ(first, display.GetFrameHash());
+}
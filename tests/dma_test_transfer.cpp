@@ -0,0 +1,196 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "common.hpp"
+#include "common/ppurun.hpp"
+#include "concretememoryrange.hpp"
+#include "dma.hpp"
+#include "mmu.hpp"
+#include "nulldisplay.hpp"
+#include "ppu.hpp"
+#include "savestate.hpp"
+#include "scheduler.hpp"
+#include "videoram.hpp"
+
+namespace
+{
+constexpr int TRANSFER_CYCLES{160 * 4};
+constexpr std::uint16_t HRAM_START_ADDRESS{0xFF80};
+constexpr int DOTS_PER_LINE{456};
+
+struct DmaBus
+{
+  DmaBus()
+  {
+    mmu.AddMemoryRange(vram);
+    mmu.AddMemoryRange(workRam);
+    // a page shared by two ranges has no host memory
+    mmu.AddMemoryRange(std::make_shared<ConcreteMemoryRange>(0x80, 0xD000));
+    mmu.AddMemoryRange(std::make_shared<ConcreteMemoryRange>(0x80, 0xD080));
+    mmu.AddMemoryRange(hram);
+    mmu.AddMemoryRange(ppu);
+    mmu.AddMemoryRange(dma);
+  }
+
+  void Fill(std::uint16_t start, std::uint8_t seed)
+  {
+    for (std::uint16_t offset{0}; offset < OAM_SIZE; ++offset)
+    {
+      mmu.Write(static_cast<std::uint16_t>(start + offset),
+          static_cast<std::uint8_t>(seed + offset));
+    }
+  }
+
+  void FinishTransfer()
+  {
+    scheduler.Advance(TRANSFER_CYCLES);
+    scheduler.RunDueEvents();
+  }
+
+  void ExpectOam(std::uint8_t seed)
+  {
+    for (std::uint16_t offset{0}; offset < OAM_SIZE; ++offset)
+    {
+      auto addr = static_cast<std::uint16_t>(OAM_START_ADDRESS + offset);
+      ASSERT_EQ(mmu.Read(addr), static_cast<std::uint8_t>(seed + offset));
+    }
+  }
+
+  MemoryManagementUnit mmu;
+  Scheduler scheduler;
+  NullDisplay display;
+  std::shared_ptr<VideoRam> vram{std::make_shared<VideoRam>()};
+  std::shared_ptr<ConcreteMemoryRange> workRam{
+      std::make_shared<ConcreteMemoryRange>(0x1000, 0xC000)};
+  std::shared_ptr<ConcreteMemoryRange> hram{
+      std::make_shared<ConcreteMemoryRange>(0x7F, HRAM_START_ADDRESS)};
+  std::shared_ptr<Ppu> ppu{
+      std::make_shared<Ppu>(mmu, *vram, display, scheduler)};
+  std::shared_ptr<Dma> dma{std::make_shared<Dma>(mmu, *ppu, scheduler)};
+};
+
+// Render two frames of a fixed vram pattern, with a DMA from vram started at
+// the beginning of every line when dmaEveryLine is set
+void RenderPattern(PpuRun &run, bool dmaEveryLine)
+{
+  auto dma = std::make_shared<Dma>(run.mmu, *run.ppu, run.scheduler);
+  run.mmu.AddMemoryRange(dma);
+  std::uint32_t seed{12345};
+  for (std::uint16_t addr{0x8000}; addr < 0xA000; ++addr)
+  {
+    seed = (seed * 1103515245U) + 12345U;
+    run.mmu.Write(addr, static_cast<std::uint8_t>(seed >> 16U));
+  }
+  // objects are off, the transfer fills oam with tile data
+  run.mmu.Write(LCDC_REGISTER_ADDRESS, 0x91);
+  int dots{0};
+  run.Run(
+      [&]()
+      {
+        if (dmaEveryLine && dots++ % DOTS_PER_LINE == 0)
+        {
+          run.mmu.Write(DMA_REGISTER_ADDRESS, 0x80);
+        }
+      });
+}
+
+void ExpectSameFrameDuringTransfer(Ppu::RenderMode renderMode)
+{
+  PpuRun idle{renderMode};
+  PpuRun transferring{renderMode};
+  RenderPattern(idle, false);
+  RenderPattern(transferring, true);
+  EXPECT_TRUE(std::ranges::equal(idle.display.GetFramebuffer(),
+      transferring.display.GetFramebuffer()));
+}
+}  // namespace
+
+TEST(DMA_TRANSFER, COPIES_PAGE_TO_OAM)
+{
+  DmaBus bus;
+  bus.Fill(0xC300, 0x10);
+  bus.mmu.Write(DMA_REGISTER_ADDRESS, 0xC3);
+  EXPECT_EQ(bus.mmu.Read(DMA_REGISTER_ADDRESS), 0xC3);
+  EXPECT_TRUE(bus.dma->IsActive());
+  bus.FinishTransfer();
+  EXPECT_FALSE(bus.dma->IsActive());
+  bus.ExpectOam(0x10);
+
+  // echo ram sources read work ram
+  bus.Fill(0xC400, 0x40);
+  bus.mmu.Write(DMA_REGISTER_ADDRESS, 0xE4);
+  bus.FinishTransfer();
+  bus.ExpectOam(0x40);
+}
+
+TEST(DMA_TRANSFER, READS_PAGES_WITHOUT_HOST_MEMORY_THROUGH_MMU)
+{
+  DmaBus bus;
+  ASSERT_EQ(bus.mmu.PageMemory(0xD000), nullptr);
+  bus.Fill(0xD000, 0x70);
+  bus.mmu.Write(DMA_REGISTER_ADDRESS, 0xD0);
+  bus.FinishTransfer();
+  bus.ExpectOam(0x70);
+}
+
+TEST(DMA_TRANSFER, LOCKS_SOURCE_BUS_UNTIL_TRANSFER_ENDS)
+{
+  DmaBus bus;
+  bus.mmu.Write(0xC000, 0x12);
+  bus.mmu.Write(0x8000, 0x34);
+  bus.mmu.Write(HRAM_START_ADDRESS, 0x56);
+
+  bus.mmu.Write(DMA_REGISTER_ADDRESS, 0xC1);
+  bus.scheduler.Advance(TRANSFER_CYCLES - 4);
+  bus.scheduler.RunDueEvents();
+  // external bus and oam read 0xFF and ignore writes, vram and hram don't
+  EXPECT_EQ(bus.mmu.Read(0xC000), 0xFF);
+  EXPECT_EQ(bus.mmu.Read(OAM_START_ADDRESS), 0xFF);
+  bus.mmu.Write(0xC000, 0x78);
+  EXPECT_EQ(bus.mmu.Read(0x8000), 0x34);
+  EXPECT_EQ(bus.mmu.Read(HRAM_START_ADDRESS), 0x56);
+
+  bus.scheduler.Advance(4);
+  bus.scheduler.RunDueEvents();
+  EXPECT_EQ(bus.mmu.Read(0xC000), 0x12);
+
+  // a vram source locks vram instead
+  bus.mmu.Write(DMA_REGISTER_ADDRESS, 0x80);
+  EXPECT_EQ(bus.mmu.Read(0x8000), 0xFF);
+  EXPECT_EQ(bus.mmu.Read(0xC000), 0x12);
+  EXPECT_EQ(bus.mmu.Read(OAM_START_ADDRESS), 0xFF);
+}
+
+TEST(DMA_TRANSFER, SAVE_STATE_RESTORES_LOCKOUT)
+{
+  DmaBus bus;
+  bus.mmu.Write(0xC000, 0x12);
+  bus.mmu.Write(DMA_REGISTER_ADDRESS, 0xC1);
+
+  std::vector<std::uint8_t> state;
+  SaveStateWriter writer{state};
+  bus.scheduler.SaveState(writer);
+  bus.dma->SaveState(writer);
+
+  bus.FinishTransfer();
+  EXPECT_EQ(bus.mmu.Read(0xC000), 0x12);
+
+  SaveStateReader reader{state};
+  bus.scheduler.LoadState(reader);
+  bus.dma->LoadState(reader);
+  EXPECT_TRUE(bus.dma->IsActive());
+  EXPECT_EQ(bus.mmu.Read(0xC000), 0xFF);
+  bus.FinishTransfer();
+  EXPECT_EQ(bus.mmu.Read(0xC000), 0x12);
+}
+
+TEST(DMA_TRANSFER, PPU_RENDERS_PAST_VRAM_SOURCE_LOCK)
+{
+  // the lock only cuts off the cpu, the ppu still reads tile maps and data
+  ExpectSameFrameDuringTransfer(Ppu::RenderMode::Dot);
+  ExpectSameFrameDuringTransfer(Ppu::RenderMode::Scanline);
+}
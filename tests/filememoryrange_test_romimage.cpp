@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "common/testroms.hpp"
+#include "filememoryrange.hpp"
+#include "machine.hpp"
+#include "memorydisplay.hpp"
+#include "romimage.hpp"
+
+TEST(FILE_MEMORY_RANGE_ROM_IMAGE, WRITES_DONT_CHANGE_IMAGE)
+{
+  TestRoms roms;
+  auto image = RomImage::Open(roms.romPath);
+  ASSERT_EQ(image->Data().size(), ROM_SIZE);
+  EXPECT_EQ(image->Data()[ENTRY_POINT], PROGRAM.front());
+
+  FileMemoryRange rom;
+  rom.Load(image, 0x0);
+  FileMemoryRange other;
+  other.Load(image, 0x0);
+  EXPECT_EQ(rom.GetStorage().data, other.GetStorage().data);
+  EXPECT_FALSE(rom.GetStorage().writable);
+
+  rom.Write(ENTRY_POINT, 0x42);
+  rom.Address(ENTRY_POINT) = 0x42;
+  EXPECT_EQ(rom.Read(ENTRY_POINT), PROGRAM.front());
+  EXPECT_EQ(other.Read(ENTRY_POINT), PROGRAM.front());
+  EXPECT_EQ(rom.Read(ROM_SIZE), 0xFF);
+}
+
+TEST(FILE_MEMORY_RANGE_ROM_IMAGE, MACHINES_SHARE_IMAGE)
+{
+  TestRoms roms;
+  MemoryDisplay display{true};
+  Machine machine{
+      roms.bootRomPath, roms.romPath, display, Ppu::RenderMode::Dot};
+  auto expected = RunFrames(machine, display, 3);
+
+  auto bootRom = RomImage::Open(roms.bootRomPath);
+  auto rom = RomImage::Open(roms.romPath);
+  MemoryDisplay firstDisplay{true};
+  Machine first{bootRom, rom, firstDisplay, Ppu::RenderMode::Dot};
+  MemoryDisplay secondDisplay{true};
+  Machine second{bootRom, rom, secondDisplay, Ppu::RenderMode::Dot};
+  EXPECT_EQ(rom.use_count(), 3);
+
+  EXPECT_EQ(RunFrames(first, firstDisplay, 3), expected);
+  EXPECT_EQ(RunFrames(second, secondDisplay, 3), expected);
+}
+
+TEST(FILE_MEMORY_RANGE_ROM_IMAGE, REJECTS_MISSING_AND_EMPTY_FILES)
+{
+  auto path = std::filesystem::temp_directory_path()
+              / std::format("noobboy_test_{}.gb", std::random_device{}());
+  EXPECT_THROW(static_cast<void>(RomImage::Open(path.string())),
+      std::runtime_error);
+
+  WriteFile(path, {});
+  EXPECT_THROW(static_cast<void>(RomImage::Open(path.string())),
+      std::runtime_error);
+  std::filesystem::remove(path);
+}
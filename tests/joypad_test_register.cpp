@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+
+#include "common.hpp"
+#include "interrupt.hpp"
+#include "joypad.hpp"
+#include "mmu.hpp"
+
+namespace
+{
+constexpr std::uint8_t SELECT_DPAD{0x20};
+constexpr std::uint8_t SELECT_ACTION{0x10};
+constexpr std::uint8_t SELECT_NONE{0x30};
+constexpr std::uint8_t JOYPAD_INTERRUPT{1U << InterruptType::JOYPAD};
+
+struct JoypadBus
+{
+  JoypadBus()
+  {
+    mmu.AddMemoryRange(std::make_shared<Interrupt>());
+    mmu.AddMemoryRange(joypad);
+  }
+
+  MemoryManagementUnit mmu;
+  std::shared_ptr<Joypad> joypad{std::make_shared<Joypad>(mmu)};
+};
+}  // namespace
+
+TEST(JOYPAD_REGISTER, READS_SELECTED_GROUP)
+{
+  JoypadBus bus;
+  bus.joypad->SetButtons(JoypadButton::LEFT | JoypadButton::START);
+
+  bus.mmu.Write(JOYPAD_REGISTER_ADDRESS, SELECT_NONE);
+  EXPECT_EQ(bus.mmu.Read(JOYPAD_REGISTER_ADDRESS), 0xFF);
+
+  bus.mmu.Write(JOYPAD_REGISTER_ADDRESS, SELECT_DPAD);
+  EXPECT_EQ(bus.mmu.Read(JOYPAD_REGISTER_ADDRESS), 0xED);
+
+  bus.mmu.Write(JOYPAD_REGISTER_ADDRESS, SELECT_ACTION);
+  EXPECT_EQ(bus.mmu.Read(JOYPAD_REGISTER_ADDRESS), 0xD7);
+
+  // writes only change the select bits
+  bus.mmu.Write(JOYPAD_REGISTER_ADDRESS, 0x00);
+  EXPECT_EQ(bus.mmu.Read(JOYPAD_REGISTER_ADDRESS), 0xC5);
+}
+
+TEST(JOYPAD_REGISTER, REQUESTS_INTERRUPT_ON_PRESS)
+{
+  JoypadBus bus;
+  bus.mmu.Write(JOYPAD_REGISTER_ADDRESS, SELECT_ACTION);
+
+  // buttons of a group that isn't selected don't pull any line low
+  bus.joypad->SetButtons(JoypadButton::UP);
+  EXPECT_EQ(bus.mmu.Read(INTERRUPT_FLAG) & JOYPAD_INTERRUPT, 0);
+
+  bus.joypad->SetButtons(JoypadButton::UP | JoypadButton::A);
+  EXPECT_NE(bus.mmu.Read(INTERRUPT_FLAG) & JOYPAD_INTERRUPT, 0);
+
+  // releasing doesn't request it
+  bus.mmu.Write(INTERRUPT_FLAG, 0);
+  bus.joypad->SetButtons(0);
+  EXPECT_EQ(bus.mmu.Read(INTERRUPT_FLAG) & JOYPAD_INTERRUPT, 0);
+
+  // selecting a group with a button held does
+  bus.joypad->SetButtons(JoypadButton::UP);
+  bus.mmu.Write(JOYPAD_REGISTER_ADDRESS, SELECT_DPAD);
+  EXPECT_NE(bus.mmu.Read(INTERRUPT_FLAG) & JOYPAD_INTERRUPT, 0);
+}
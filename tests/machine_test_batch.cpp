@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <random>
+#include <vector>
+
+#include "batchrunner.hpp"
+#include "common/testroms.hpp"
+#include "joypad.hpp"
+#include "machine.hpp"
+#include "memorydisplay.hpp"
+#include "movie.hpp"
+
+TEST(MACHINE_BATCH, MATCHES_SEQUENTIAL_RUNS)
+{
+  TestRoms roms;
+  TestRoms joypadRoms{JOYPAD_PROGRAM};
+  auto moviePath =
+      std::filesystem::temp_directory_path()
+      / std::format("noobboy_test_{}.movie", std::random_device{}());
+  Movie movie;
+  for (std::uint64_t frame{0}; frame < 20; ++frame)
+  {
+    movie.Record(frame, frame < 10 ? JoypadButton::UP : JoypadButton::RIGHT);
+  }
+  movie.Save(moviePath.string());
+
+  std::vector<BatchJob> jobs;
+  for (std::uint64_t i{0}; i < 12; ++i)
+  {
+    auto renderMode =
+        i % 2 == 0 ? Ppu::RenderMode::Dot : Ppu::RenderMode::Scanline;
+    if (i % 3 == 0)
+    {
+      jobs.push_back({.bootRomPath = joypadRoms.bootRomPath,
+          .romPath = joypadRoms.romPath,
+          .moviePath = moviePath.string(),
+          .renderMode = renderMode});
+    }
+    else
+    {
+      jobs.push_back({.bootRomPath = roms.bootRomPath,
+          .romPath = roms.romPath,
+          .frames = 1 + i,
+          .renderMode = renderMode});
+    }
+  }
+
+  auto results = BatchRunner{4}.Run(jobs);
+  auto sequential = BatchRunner{1}.Run(jobs);
+  std::filesystem::remove(moviePath);
+
+  ASSERT_EQ(results.size(), jobs.size());
+  for (std::size_t i{0}; i < jobs.size(); ++i)
+  {
+    EXPECT_TRUE(results[i].error.empty()) << results[i].error;
+    EXPECT_EQ(results[i].frames, jobs[i].frames != 0 ? jobs[i].frames : 20U);
+    EXPECT_EQ(results[i].frameHash, sequential[i].frameHash);
+  }
+
+  // and the same as driving the machine directly
+  MemoryDisplay display{true};
+  Machine machine{
+      roms.bootRomPath, roms.romPath, display, Ppu::RenderMode::Scanline};
+  EXPECT_EQ(RunFrames(machine, display, 2).back(), results[1].frameHash);
+}
+
+TEST(MACHINE_BATCH, FAILED_JOB_DOESNT_STOP_BATCH)
+{
+  TestRoms roms;
+  std::vector<BatchJob> jobs{
+      {.bootRomPath = roms.bootRomPath, .romPath = "missing.gb", .frames = 1},
+      {.bootRomPath = roms.bootRomPath, .romPath = roms.romPath},
+      {.bootRomPath = roms.bootRomPath, .romPath = roms.romPath, .frames = 3},
+  };
+
+  auto results = BatchRunner{2}.Run(jobs);
+  EXPECT_FALSE(results[0].error.empty());
+  EXPECT_FALSE(results[1].error.empty());
+  EXPECT_TRUE(results[2].error.empty());
+  EXPECT_EQ(results[2].frames, 3U);
+}
@@ -0,0 +1,39 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "common/testroms.hpp"
+#include "machine.hpp"
+#include "memorydisplay.hpp"
+
+TEST(MACHINE_HALT, WAKES_UP_EVERY_FRAME)
+{
+  TestRoms roms{HALT_PROGRAM};
+  for (auto renderMode : {Ppu::RenderMode::Dot, Ppu::RenderMode::Scanline})
+  {
+    MemoryDisplay display{true};
+    Machine machine{roms.bootRomPath, roms.romPath, display, renderMode};
+    auto hashes = RunFrames(machine, display, 8);
+    for (std::size_t frame{2}; frame < hashes.size(); ++frame)
+    {
+      EXPECT_NE(hashes[frame], hashes[frame - 1]) << "frame " << frame;
+    }
+  }
+}
+
+TEST(MACHINE_HALT, RESTORES_HALTED_MACHINE)
+{
+  TestRoms roms{HALT_PROGRAM};
+  MemoryDisplay display{true};
+  Machine machine{
+      roms.bootRomPath, roms.romPath, display, Ppu::RenderMode::Dot};
+  RunFrames(machine, display, 3);
+
+  std::vector<std::uint8_t> state;
+  machine.SaveState(state);
+  auto expected = RunFrames(machine, display, 5);
+
+  machine.LoadState(state);
+  EXPECT_EQ(RunFrames(machine, display, 5), expected);
+}
@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "common/cpurun.hpp"
+#include "cpu.hpp"
+#include "idleloopdetector.hpp"
+#include "scheduler.hpp"
+
+namespace
+{
+constexpr int ITERATION_CYCLES{28};
+constexpr std::uint64_t EVENT_CYCLE{1000};
+
+// The loop loaded by a cpu run that isn't ticked, iterations are timed and
+// reported to the detector by hand
+struct LoopRun
+{
+  explicit LoopRun(const std::vector<std::uint8_t> &loop)
+      : run(std::span<const std::uint8_t>{loop}),
+        state{run.State()},
+        loopEnd{static_cast<std::uint16_t>(
+            CPU_RUN_PROGRAM_ADDRESS + loop.size())}
+  {
+    run.scheduler.SetHandler(Scheduler::EventType::PpuModeChange, [] {});
+    run.scheduler.Schedule(Scheduler::EventType::PpuModeChange, EVENT_CYCLE);
+  }
+
+  // Run an iteration of the loop, as far as the detector can tell
+  void Iterate()
+  {
+    run.scheduler.Advance(ITERATION_CYCLES);
+    detector.OnBackwardJump(state, loopEnd, run.scheduler);
+  }
+
+  CpuRun run;
+  IdleLoopDetector detector{run.mmu};
+  CpuState state;
+  std::uint16_t loopEnd;
+};
+
+// LDH A, (LY); CP 0x90; JR NZ, loop
+const std::vector<std::uint8_t> LY_LOOP{0xF0, 0x44, 0xFE, 0x90, 0x20, 0xFA};
+}  // namespace
+
+TEST(IDLE_LOOP, SKIPS_TO_NEXT_EVENT)
+{
+  LoopRun loop{LY_LOOP};
+  loop.Iterate();
+  EXPECT_EQ(loop.run.scheduler.Now(), ITERATION_CYCLES);
+  loop.Iterate();
+  // whole iterations up to the event, it isn't passed
+  auto now = loop.run.scheduler.Now();
+  EXPECT_LE(now, EVENT_CYCLE);
+  EXPECT_GT(now + ITERATION_CYCLES, EVENT_CYCLE);
+  EXPECT_EQ(now % ITERATION_CYCLES, 0U);
+
+  // nothing is skipped again until events ran and the loop repeated
+  loop.detector.Reset();
+  loop.Iterate();
+  EXPECT_EQ(loop.run.scheduler.Now(), now + ITERATION_CYCLES);
+}
+
+TEST(IDLE_LOOP, RUNS_LOOPS_THAT_CHANGE_STATE)
+{
+  LoopRun loop{LY_LOOP};
+  loop.Iterate();
+  ++loop.state.BC.high;
+  loop.Iterate();
+  EXPECT_EQ(loop.run.scheduler.Now(), 2 * ITERATION_CYCLES);
+}
+
+TEST(IDLE_LOOP, RUNS_LOOPS_THAT_ACCESS_MEMORY)
+{
+  const std::vector<std::vector<std::uint8_t>> loops{
+      // LDH A, (DIV); CP 0x90; JR NZ, loop
+      {0xF0, 0x04, 0xFE, 0x90, 0x20, 0xFA},
+      // LD A, (HL); CP 0x90; JR NZ, loop
+      {0x7E, 0xFE, 0x90, 0x20, 0xFB},
+      // LDH A, (LY); LD (HL), A; JR loop
+      {0xF0, 0x44, 0x77, 0x18, 0xFB},
+      // LDH A, (LY); CP 0x90; JR NZ, loop; JR loop (leaves the loop)
+      {0xF0, 0x44, 0xFE, 0x90, 0x20, 0x02, 0x18, 0xF8},
+  };
+  for (const auto &program : loops)
+  {
+    LoopRun loop{program};
+    loop.Iterate();
+    loop.Iterate();
+    EXPECT_EQ(loop.run.scheduler.Now(), 2 * ITERATION_CYCLES);
+  }
+}
+
+TEST(IDLE_LOOP, RUNS_LOOPS_WITHOUT_PENDING_EVENT)
+{
+  LoopRun loop{LY_LOOP};
+  loop.run.scheduler.Cancel(Scheduler::EventType::PpuModeChange);
+  loop.Iterate();
+  loop.Iterate();
+  EXPECT_EQ(loop.run.scheduler.Now(), 2 * ITERATION_CYCLES);
+}
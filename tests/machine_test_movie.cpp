@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "common/testroms.hpp"
+#include "joypad.hpp"
+#include "machine.hpp"
+#include "memorydisplay.hpp"
+#include "movie.hpp"
+
+namespace
+{
+constexpr int FRAMES{60};
+
+// Run the machine feeding it input from movie, return the hash of every frame
+std::vector<std::uint64_t> Replay(const TestRoms &roms, const Movie &movie)
+{
+  MemoryDisplay display{true};
+  Machine machine{
+      roms.bootRomPath, roms.romPath, display, Ppu::RenderMode::Dot};
+  std::vector<std::uint64_t> hashes;
+  while (machine.FrameCount() < movie.FrameCount())
+  {
+    machine.SetButtons(movie.ButtonsAt(machine.FrameCount()));
+    machine.RunFrame();
+    hashes.push_back(display.GetFrameHash());
+  }
+  return hashes;
+}
+}  // namespace
+
+TEST(MACHINE_MOVIE, REPLAYS_RECORDED_RUN)
+{
+  TestRoms roms{JOYPAD_PROGRAM};
+  MemoryDisplay display{true};
+  Machine machine{
+      roms.bootRomPath, roms.romPath, display, Ppu::RenderMode::Dot};
+
+  Movie movie;
+  std::vector<std::uint64_t> hashes;
+  for (int frame{0}; frame < FRAMES; ++frame)
+  {
+    // hold each direction for a few frames
+    auto buttons = static_cast<std::uint8_t>(1U << ((frame / 7) % 4));
+    movie.Record(machine.FrameCount(), buttons);
+    machine.SetButtons(buttons);
+    machine.RunFrame();
+    hashes.push_back(display.GetFrameHash());
+  }
+  ASSERT_EQ(movie.FrameCount(), static_cast<std::uint64_t>(FRAMES));
+
+  auto path = std::filesystem::temp_directory_path()
+              / std::format("noobboy_test_{}.movie", std::random_device{}());
+  movie.Save(path.string());
+  auto loaded = Movie::Load(path.string());
+  // only the frames the buttons change at are stored
+  EXPECT_LT(std::filesystem::file_size(path), 64U);
+  std::filesystem::remove(path);
+
+  EXPECT_EQ(Replay(roms, loaded), hashes);
+  // input makes a difference, the run without it differs
+  Movie noInput;
+  noInput.Record(FRAMES - 1, 0);
+  EXPECT_NE(Replay(roms, noInput), hashes);
+}
+
+TEST(MACHINE_MOVIE, RECORDS_OVER_REWOUND_FRAMES)
+{
+  Movie movie;
+  movie.Record(0, JoypadButton::A);
+  movie.Record(1, JoypadButton::A);
+  movie.Record(2, JoypadButton::B);
+  movie.Record(3, JoypadButton::B);
+  EXPECT_EQ(movie.ButtonsAt(1), JoypadButton::A);
+  EXPECT_EQ(movie.ButtonsAt(3), JoypadButton::B);
+
+  // went back to frame 2
+  movie.Record(2, JoypadButton::START);
+  EXPECT_EQ(movie.FrameCount(), 3U);
+  EXPECT_EQ(movie.ButtonsAt(1), JoypadButton::A);
+  EXPECT_EQ(movie.ButtonsAt(2), JoypadButton::START);
+  EXPECT_EQ(movie.ButtonsAt(3), 0);
+}
+
+TEST(MACHINE_MOVIE, REJECTS_INVALID_FILES)
+{
+  auto path = std::filesystem::temp_directory_path()
+              / std::format("noobboy_test_{}.movie", std::random_device{}());
+  WriteFile(path, {'N', 'O', 'P', 'E', 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0});
+  EXPECT_THROW(static_cast<void>(Movie::Load(path.string())),
+      std::runtime_error);
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "common/testroms.hpp"
+#include "machine.hpp"
+#include "memorydisplay.hpp"
+#include "rewindbuffer.hpp"
+
+namespace
+{
+constexpr std::size_t LARGE_CAPACITY{1024 * 1024};
+
+// Run frames feeding the rewind buffer, returns the state after every frame
+std::vector<std::vector<std::uint8_t>> RunAndRecord(
+    Machine &machine, RewindBuffer &rewind, int frames)
+{
+  std::vector<std::vector<std::uint8_t>> states;
+  for (int frame{0}; frame < frames; ++frame)
+  {
+    machine.RunFrame();
+    rewind.OnFrame(machine);
+    states.emplace_back();
+    machine.SaveState(states.back());
+  }
+  return states;
+}
+}  // namespace
+
+TEST(MACHINE_REWIND, RESTORES_EVERY_SNAPSHOT)
+{
+  TestRoms roms;
+  MemoryDisplay display{false};
+  Machine machine{
+      roms.bootRomPath, roms.romPath, display, Ppu::RenderMode::Dot};
+  RewindBuffer rewind{LARGE_CAPACITY, 1};
+  auto states = RunAndRecord(machine, rewind, 20);
+  ASSERT_EQ(rewind.SnapshotCount(), states.size());
+  // deltas are much smaller than whole states
+  EXPECT_LT(rewind.UsedBytes(), states.size() * states.front().size() / 4);
+
+  std::vector<std::uint8_t> state;
+  for (auto it = states.rbegin(); it != states.rend(); ++it)
+  {
+    ASSERT_TRUE(rewind.Rewind(machine));
+    machine.SaveState(state);
+    EXPECT_EQ(state, *it);
+  }
+  EXPECT_FALSE(rewind.Rewind(machine));
+  EXPECT_EQ(rewind.SnapshotCount(), 0U);
+}
+
+TEST(MACHINE_REWIND, SNAPSHOTS_EVERY_INTERVAL)
+{
+  TestRoms roms;
+  MemoryDisplay display{false};
+  Machine machine{
+      roms.bootRomPath, roms.romPath, display, Ppu::RenderMode::Dot};
+  RewindBuffer rewind{LARGE_CAPACITY, 4};
+  auto states = RunAndRecord(machine, rewind, 14);
+  EXPECT_EQ(rewind.SnapshotCount(), 3U);
+
+  std::vector<std::uint8_t> state;
+  for (std::size_t frame : {11U, 7U, 3U})
+  {
+    ASSERT_TRUE(rewind.Rewind(machine));
+    machine.SaveState(state);
+    EXPECT_EQ(state, states[frame]);
+  }
+}
+
+TEST(MACHINE_REWIND, DROPS_OLDEST_SNAPSHOTS_WHEN_FULL)
+{
+  TestRoms roms;
+  MemoryDisplay display{false};
+  Machine machine{
+      roms.bootRomPath, roms.romPath, display, Ppu::RenderMode::Dot};
+  constexpr std::size_t CAPACITY{8 * 1024};
+  RewindBuffer rewind{CAPACITY, 1};
+  auto states = RunAndRecord(machine, rewind, 60);
+  auto count = rewind.SnapshotCount();
+  EXPECT_GT(count, 1U);
+  EXPECT_LT(count, states.size());
+  EXPECT_LE(rewind.UsedBytes(), CAPACITY);
+
+  // the snapshots that are left still restore exactly
+  std::vector<std::uint8_t> state;
+  for (std::size_t i{0}; i < count; ++i)
+  {
+    ASSERT_TRUE(rewind.Rewind(machine));
+    machine.SaveState(state);
+    EXPECT_EQ(state, states[states.size() - 1 - i]);
+  }
+  EXPECT_FALSE(rewind.Rewind(machine));
+}
@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "common/testroms.hpp"
+#include "machine.hpp"
+#include "memorydisplay.hpp"
+
+TEST(MACHINE_SAVE_STATE, RESTORES_SAME_MACHINE)
+{
+  TestRoms roms;
+  MemoryDisplay display{true};
+  Machine machine{
+      roms.bootRomPath, roms.romPath, display, Ppu::RenderMode::Dot};
+  RunFrames(machine, display, 3);
+
+  std::vector<std::uint8_t> state;
+  machine.SaveState(state);
+  auto expected = RunFrames(machine, display, 5);
+  ASSERT_NE(expected.front(), expected.back());
+
+  machine.LoadState(state);
+  EXPECT_EQ(RunFrames(machine, display, 5), expected);
+}
+
+TEST(MACHINE_SAVE_STATE, RESTORES_INTO_NEW_MACHINE)
+{
+  TestRoms roms;
+  for (auto renderMode : {Ppu::RenderMode::Dot, Ppu::RenderMode::Scanline})
+  {
+    MemoryDisplay display{true};
+    Machine machine{roms.bootRomPath, roms.romPath, display, renderMode};
+    RunFrames(machine, display, 2);
+
+    std::vector<std::uint8_t> state;
+    machine.SaveState(state);
+    std::vector<std::uint8_t> again;
+    machine.SaveState(again);
+    EXPECT_EQ(state, again);
+    auto expected = RunFrames(machine, display, 5);
+
+    MemoryDisplay otherDisplay{true};
+    Machine other{roms.bootRomPath, roms.romPath, otherDisplay, renderMode};
+    other.LoadState(state);
+    EXPECT_EQ(other.FrameCount(), machine.FrameCount() - 5);
+    EXPECT_EQ(RunFrames(other, otherDisplay, 5), expected);
+  }
+}
+
+TEST(MACHINE_SAVE_STATE, REJECTS_INVALID_STATES)
+{
+  TestRoms roms;
+  MemoryDisplay display{false};
+  Machine machine{
+      roms.bootRomPath, roms.romPath, display, Ppu::RenderMode::Dot};
+  machine.RunFrame();
+  std::vector<std::uint8_t> state;
+  machine.SaveState(state);
+
+  auto badMagic = state;
+  badMagic[0] = 'X';
+  EXPECT_THROW(machine.LoadState(badMagic), std::runtime_error);
+
+  auto truncated = state;
+  truncated.pop_back();
+  EXPECT_THROW(machine.LoadState(truncated), std::runtime_error);
+
+  MemoryDisplay otherDisplay{false};
+  Machine other{
+      roms.bootRomPath, roms.romPath, otherDisplay, Ppu::RenderMode::Scanline};
+  EXPECT_THROW(other.LoadState(state), std::runtime_error);
+}
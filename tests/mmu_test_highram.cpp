@@ -0,0 +1,50 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+
+#include "concretememoryrange.hpp"
+#include "mmu.hpp"
+
+namespace
+{
+constexpr std::uint16_t HIGH_RAM_END_ADDRESS{0xFFFE};
+constexpr std::uint16_t IE_ADDRESS{0xFFFF};
+}  // namespace
+
+TEST(MMU_HIGH_RAM, SHARES_PAGE_WITH_IO_REGISTERS)
+{
+  MemoryManagementUnit mmu;
+  auto io = std::make_shared<ConcreteMemoryRange>(0x80, 0xFF00);
+  auto hram = std::make_shared<ConcreteMemoryRange>(0x7F, 0xFF80);
+  auto ie = std::make_shared<ConcreteMemoryRange>(0x01, IE_ADDRESS);
+  mmu.AddMemoryRange(io);
+  mmu.AddMemoryRange(hram);
+  mmu.AddMemoryRange(ie);
+
+  mmu.Write(MemoryManagementUnit::HIGH_RAM_START_ADDRESS, 0x11);
+  mmu.Write(HIGH_RAM_END_ADDRESS, 0x22);
+  mmu.Write(IE_ADDRESS, 0x33);
+  mmu.Write(0xFF7F, 0x44);
+  EXPECT_EQ(hram->Read(MemoryManagementUnit::HIGH_RAM_START_ADDRESS), 0x11);
+  EXPECT_EQ(hram->Read(HIGH_RAM_END_ADDRESS), 0x22);
+  EXPECT_EQ(ie->Read(IE_ADDRESS), 0x33);
+  EXPECT_EQ(io->Read(0xFF7F), 0x44);
+
+  hram->Write(HIGH_RAM_END_ADDRESS, 0x55);
+  EXPECT_EQ(mmu.Read(HIGH_RAM_END_ADDRESS), 0x55);
+  EXPECT_EQ(mmu.Read(IE_ADDRESS), 0x33);
+}
+
+TEST(MMU_HIGH_RAM, FIRST_REGISTERED_RANGE_WINS)
+{
+  MemoryManagementUnit mmu;
+  auto page = std::make_shared<ConcreteMemoryRange>(0x100, 0xFF00);
+  auto hram = std::make_shared<ConcreteMemoryRange>(0x7F, 0xFF80);
+  mmu.AddMemoryRange(page);
+  mmu.AddMemoryRange(hram);
+
+  mmu.Write(MemoryManagementUnit::HIGH_RAM_START_ADDRESS, 0x11);
+  EXPECT_EQ(page->Read(MemoryManagementUnit::HIGH_RAM_START_ADDRESS), 0x11);
+  EXPECT_EQ(hram->Read(MemoryManagementUnit::HIGH_RAM_START_ADDRESS), 0x00);
+}
@@ -0,0 +1,46 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+#include "pixelfifo.hpp"
+
+TEST(PPU_PIXEL_FIFO, PUSH_POP_IN_ORDER)
+{
+  PixelFifo fifo;
+  EXPECT_TRUE(fifo.Empty());
+  // fill and drain repeatedly so head wraps around the ring
+  for (unsigned int round{0}; round < 5; ++round)
+  {
+    for (unsigned int i{0}; i < 11; ++i)
+    {
+      fifo.Push({.color = static_cast<std::uint8_t>(i & 0x3U),
+          .palette = static_cast<std::uint8_t>(i & 0x1U),
+          .bgPriority = static_cast<std::uint8_t>((i >> 1U) & 0x1U)});
+    }
+    EXPECT_EQ(fifo.Size(), 11U);
+    for (unsigned int i{0}; i < 11; ++i)
+    {
+      auto entry = fifo.Pop();
+      EXPECT_EQ(entry.color, i & 0x3U);
+      EXPECT_EQ(entry.palette, i & 0x1U);
+      EXPECT_EQ(entry.bgPriority, (i >> 1U) & 0x1U);
+    }
+    EXPECT_TRUE(fifo.Empty());
+  }
+}
+
+TEST(PPU_PIXEL_FIFO, FULL_CAPACITY)
+{
+  PixelFifo fifo;
+  fifo.Push({.color = 1, .palette = 0, .bgPriority = 0});
+  fifo.Pop();
+  for (std::size_t i{0}; i < PixelFifo::CAPACITY; ++i)
+  {
+    fifo.Push({.color = 2, .palette = 1, .bgPriority = 0});
+  }
+  EXPECT_EQ(fifo.Size(), PixelFifo::CAPACITY);
+  fifo[3].color = 3;
+  EXPECT_EQ(fifo[3].color, 3U);
+  fifo.Clear();
+  EXPECT_TRUE(fifo.Empty());
+}
@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+
+#include "common.hpp"
+#include "common/ppurun.hpp"
+#include "ppu.hpp"
+
+namespace
+{
+// Fill vram with a fixed pattern, set up the registers and run two frames
+void SetUpPpu(PpuRun &run, std::uint8_t lcdc, std::uint8_t scx,
+    std::uint8_t scy, std::uint8_t bgp)
+{
+  std::uint32_t seed{12345};
+  for (std::uint16_t addr{0x8000}; addr < 0xA000; ++addr)
+  {
+    seed = (seed * 1103515245U) + 12345U;
+    run.mmu.Write(addr, static_cast<std::uint8_t>(seed >> 16U));
+  }
+  run.mmu.Write(LCDC_REGISTER_ADDRESS, lcdc);
+  run.mmu.Write(SCX_REGISTER_ADDRESS, scx);
+  run.mmu.Write(SCY_REGISTER_ADDRESS, scy);
+  run.mmu.Write(BGP_REGISTER_ADDRESS, bgp);
+  run.mmu.Write(LYC_REGISTER_ADDRESS, 0x40);
+  run.Run();
+}
+
+void ExpectSameOutput(
+    std::uint8_t lcdc, std::uint8_t scx, std::uint8_t scy, std::uint8_t bgp)
+{
+  PpuRun dot{Ppu::RenderMode::Dot};
+  PpuRun scanline{Ppu::RenderMode::Scanline};
+  SetUpPpu(dot, lcdc, scx, scy, bgp);
+  SetUpPpu(scanline, lcdc, scx, scy, bgp);
+  EXPECT_TRUE(std::ranges::equal(
+      dot.display.GetFramebuffer(), scanline.display.GetFramebuffer()));
+  EXPECT_TRUE(dot.timeline == scanline.timeline);
+}
+}  // namespace
+
+TEST(PPU_SCANLINE, MATCHES_DOT_RENDERER)
+{
+  ExpectSameOutput(0x91, 0x00, 0x00, 0xE4);
+}
+
+TEST(PPU_SCANLINE, MATCHES_DOT_RENDERER_SCROLLED)
+{
+  ExpectSameOutput(0x91, 0x03, 0x05, 0x1B);
+  ExpectSameOutput(0x91, 0xFD, 0xF0, 0xE4);
+}
+
+TEST(PPU_SCANLINE, MATCHES_DOT_RENDERER_SIGNED_TILE_DATA)
+{
+  ExpectSameOutput(0x81, 0x07, 0x95, 0xE4);
+}
+
+TEST(PPU_SCANLINE, MATCHES_DOT_RENDERER_HIGH_TILE_MAP)
+{
+  ExpectSameOutput(0x99, 0x44, 0x21, 0xD2);
+}
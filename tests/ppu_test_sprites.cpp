@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+#include "color.hpp"
+#include "common.hpp"
+#include "common/ppurun.hpp"
+#include "oamram.hpp"
+#include "ppu.hpp"
+
+namespace
+{
+constexpr std::uint8_t LCDC_SPRITES{0x93};
+constexpr std::uint8_t LCDC_TALL_SPRITES{0x97};
+
+// Random tiles and 40 random sprites, crowded enough into the screen that
+// some lines hit the limit of 10
+void ExpectSameOutput(std::uint8_t lcdc, std::uint32_t seed)
+{
+  PpuRun dot{Ppu::RenderMode::Dot};
+  PpuRun scanline{Ppu::RenderMode::Scanline};
+  auto random = [&seed]() {
+    seed = (seed * 1103515245U) + 12345U;
+    return static_cast<std::uint8_t>(seed >> 16U);
+  };
+  for (std::uint16_t addr{0x8000}; addr < 0xA000; ++addr)
+  {
+    auto data = random();
+    dot.mmu.Write(addr, data);
+    scanline.mmu.Write(addr, data);
+  }
+  for (std::size_t index{0}; index < OamRam::SPRITE_COUNT; ++index)
+  {
+    auto y = static_cast<std::uint8_t>(random() % 64);
+    auto x = static_cast<std::uint8_t>(random() % 176);
+    auto tile = random();
+    auto flags = static_cast<std::uint8_t>(random() & 0xF0U);
+    dot.SetSprite(index, y, x, tile, flags);
+    scanline.SetSprite(index, y, x, tile, flags);
+  }
+  dot.mmu.Write(LCDC_REGISTER_ADDRESS, lcdc);
+  scanline.mmu.Write(LCDC_REGISTER_ADDRESS, lcdc);
+
+  dot.Run();
+  scanline.Run();
+  auto frame = dot.display.GetFramebuffer();
+  auto scanlineFrame = scanline.display.GetFramebuffer();
+  EXPECT_TRUE(std::equal(frame.begin(), frame.end(), scanlineFrame.begin()));
+  EXPECT_TRUE(dot.timeline == scanline.timeline);
+}
+}  // namespace
+
+TEST(PPU_SPRITES, FINDS_FIRST_TEN_IN_OAM_ORDER)
+{
+  OamRam oam;
+  // 12 sprites on line 0, x falling with the index
+  for (std::uint16_t index{0}; index < 12; ++index)
+  {
+    auto addr = static_cast<std::uint16_t>(OAM_START_ADDRESS + (index * 4));
+    oam.Write(addr, 16);
+    oam.Write(static_cast<std::uint16_t>(addr + 1),
+        static_cast<std::uint8_t>(100 - index));
+    oam.Write(static_cast<std::uint16_t>(addr + 2),
+        static_cast<std::uint8_t>(index));
+  }
+  OamRam::SpriteLine line{};
+  oam.FindSprites(0, false, line);
+  ASSERT_EQ(line.count, OamRam::MAX_SPRITES_PER_LINE);
+  // sprites 10 and 11 are dropped, the rest is sorted by x
+  for (std::size_t i{0}; i < line.count; ++i)
+  {
+    EXPECT_EQ(line.sprites[i].tile, 9 - i);
+  }
+  oam.FindSprites(8, false, line);
+  EXPECT_EQ(line.count, 0U);
+  oam.FindSprites(8, true, line);
+  EXPECT_EQ(line.count, OamRam::MAX_SPRITES_PER_LINE);
+
+  // equal x keeps oam order, written oam is picked up
+  oam.Write(OAM_START_ADDRESS + 1, 91);
+  oam.FindSprites(0, false, line);
+  EXPECT_EQ(line.sprites[0].tile, 0);
+  EXPECT_EQ(line.sprites[1].tile, 9);
+
+  std::array<std::uint8_t, OAM_SIZE> cleared{};
+  oam.WriteAll(cleared);
+  oam.FindSprites(0, false, line);
+  EXPECT_EQ(line.count, 0U);
+}
+
+TEST(PPU_SPRITES, DRAWS_FLIPPED_SPRITES_WITH_PALETTES)
+{
+  for (auto renderMode : {Ppu::RenderMode::Dot, Ppu::RenderMode::Scanline})
+  {
+    PpuRun run{renderMode};
+    // tile 1: left half color 1, right half color 3, blank background
+    for (std::uint16_t row{0}; row < 8; ++row)
+    {
+      run.mmu.Write(static_cast<std::uint16_t>(0x8010 + (row * 2)), 0xFF);
+      run.mmu.Write(static_cast<std::uint16_t>(0x8011 + (row * 2)), 0x0F);
+    }
+    run.SetSprite(0, 16 + 10, 8 + 20, 1, 0x00);
+    run.SetSprite(1, 16 + 30, 8 + 40, 1, 0x30);
+    // behind the background, which is color 0 here
+    run.SetSprite(2, 16 + 50, 8 + 60, 1, 0x80);
+    run.mmu.Write(LCDC_REGISTER_ADDRESS, LCDC_SPRITES);
+    run.Run();
+
+    EXPECT_EQ(run.Pixel(20, 10), PaletteShade(PPU_RUN_OBP0, 1));
+    EXPECT_EQ(run.Pixel(27, 10), PaletteShade(PPU_RUN_OBP0, 3));
+    EXPECT_EQ(run.Pixel(19, 10), 0);
+    EXPECT_EQ(run.Pixel(20, 9), 0);
+    EXPECT_EQ(run.Pixel(40, 30), PaletteShade(PPU_RUN_OBP1, 3));
+    EXPECT_EQ(run.Pixel(47, 30), PaletteShade(PPU_RUN_OBP1, 1));
+    EXPECT_EQ(run.Pixel(60, 50), PaletteShade(PPU_RUN_OBP0, 1));
+  }
+}
+
+TEST(PPU_SPRITES, SCANLINE_MATCHES_DOT_RENDERER)
+{
+  ExpectSameOutput(LCDC_SPRITES, 12345);
+  ExpectSameOutput(LCDC_SPRITES, 777);
+}
+
+TEST(PPU_SPRITES, SCANLINE_MATCHES_DOT_RENDERER_TALL_SPRITES)
+{
+  ExpectSameOutput(LCDC_TALL_SPRITES, 4242);
+}
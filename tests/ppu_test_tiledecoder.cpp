@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+
+#include "common.hpp"
+#include "tiledecoder.hpp"
+#include "videoram.hpp"
+
+namespace
+{
+// Color id of pixel x in a row, straight from the bit planes
+std::uint8_t ColorId(std::uint8_t low, std::uint8_t high, unsigned int x)
+{
+  auto bit = 7U - x;
+  return static_cast<std::uint8_t>(
+      (((high >> bit) & 1U) << 1U) | ((low >> bit) & 1U));
+}
+}  // namespace
+
+TEST(PPU_TILE_DECODER, DECODE_TILE)
+{
+  std::uint32_t seed{42};
+  for (int i{0}; i < 1000; ++i)
+  {
+    std::array<std::uint8_t, TILE_DATA_SIZE> tile{};
+    for (auto &data : tile)
+    {
+      seed = (seed * 1103515245U) + 12345U;
+      data = static_cast<std::uint8_t>(seed >> 16U);
+    }
+    std::array<std::uint8_t, TileDecoder::DECODED_TILE_SIZE> colorIds{};
+    TileDecoder::DecodeTile(tile.data(), colorIds.data());
+    for (unsigned int row{0}; row < TileDecoder::TILE_ROWS; ++row)
+    {
+      std::array<std::uint8_t, TileDecoder::DECODED_ROW_SIZE> rowIds{};
+      TileDecoder::DecodeTileRow(
+          tile[row * 2], tile[(row * 2) + 1], rowIds.data());
+      for (unsigned int x{0}; x < TileDecoder::DECODED_ROW_SIZE; ++x)
+      {
+        auto expected = ColorId(tile[row * 2], tile[(row * 2) + 1], x);
+        ASSERT_EQ(colorIds[(row * 8) + x], expected);
+        ASSERT_EQ(rowIds[x], expected);
+      }
+    }
+  }
+}
+
+TEST(PPU_TILE_DECODER, CACHE_INVALIDATED_ON_WRITE)
+{
+  VideoRam vram;
+  // tile 0x17 row 3: low byte 0b10100000, high byte 0b11000000
+  std::uint16_t rowAddress = VRAM_START_ADDRESS + (0x17 * TILE_DATA_SIZE) + 6;
+  vram.Write(rowAddress, 0b10100000);
+  vram.Write(rowAddress + 1, 0b11000000);
+  const auto *row = vram.GetTileRow(rowAddress);
+  EXPECT_EQ(row[0], 3);
+  EXPECT_EQ(row[1], 2);
+  EXPECT_EQ(row[2], 1);
+  EXPECT_EQ(row[3], 0);
+
+  // writes through Address (read modify write instructions) also count
+  vram.Address(rowAddress + 1) = 0b00010000;
+  row = vram.GetTileRow(rowAddress);
+  EXPECT_EQ(row[0], 1);
+  EXPECT_EQ(row[1], 0);
+  EXPECT_EQ(row[2], 1);
+  EXPECT_EQ(row[3], 2);
+
+  // tile map writes leave tile data alone
+  vram.Write(0x9800, 0xFF);
+  EXPECT_EQ(vram.GetTileRow(rowAddress)[0], 1);
+}
+
+TEST(PPU_TILE_DECODER, STORAGE_IS_READ_ONLY)
+{
+  VideoRam vram;
+  auto storage = vram.GetStorage();
+  EXPECT_NE(storage.data, nullptr);
+  EXPECT_EQ(storage.offset, VRAM_START_ADDRESS);
+  EXPECT_EQ(storage.size, VRAM_SIZE);
+  EXPECT_FALSE(storage.writable);
+}
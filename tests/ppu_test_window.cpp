@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include "common.hpp"
+#include "common/ppurun.hpp"
+#include "oamram.hpp"
+#include "ppu.hpp"
+
+namespace
+{
+constexpr std::uint8_t LCDC_WINDOW{0xF1};
+constexpr std::uint8_t LCDC_WINDOW_LOW_MAP{0xB1};
+constexpr std::uint8_t LCDC_WINDOW_SPRITES{0xF3};
+constexpr std::uint8_t LCDC_WINDOW_OFF{0xD1};
+
+// Random tiles, and random sprites if they are enabled
+void ExpectSameOutput(std::uint8_t lcdc, std::uint8_t wx, std::uint8_t wy,
+    std::uint8_t scx, std::uint32_t seed)
+{
+  PpuRun dot{Ppu::RenderMode::Dot};
+  PpuRun scanline{Ppu::RenderMode::Scanline};
+  auto random = [&seed]() {
+    seed = (seed * 1103515245U) + 12345U;
+    return static_cast<std::uint8_t>(seed >> 16U);
+  };
+  for (std::uint16_t addr{0x8000}; addr < 0xA000; ++addr)
+  {
+    auto data = random();
+    dot.mmu.Write(addr, data);
+    scanline.mmu.Write(addr, data);
+  }
+  for (std::size_t index{0}; index < OamRam::SPRITE_COUNT; ++index)
+  {
+    auto y = static_cast<std::uint8_t>(random() % 160);
+    auto x = static_cast<std::uint8_t>(random() % 176);
+    auto tile = random();
+    auto flags = static_cast<std::uint8_t>(random() & 0xF0U);
+    dot.SetSprite(index, y, x, tile, flags);
+    scanline.SetSprite(index, y, x, tile, flags);
+  }
+  for (auto *run : {&dot, &scanline})
+  {
+    run->mmu.Write(WX_REGISTER_ADDRESS, wx);
+    run->mmu.Write(WY_REGISTER_ADDRESS, wy);
+    run->mmu.Write(SCX_REGISTER_ADDRESS, scx);
+    run->mmu.Write(LCDC_REGISTER_ADDRESS, lcdc);
+    run->Run();
+  }
+  auto frame = dot.display.GetFramebuffer();
+  auto scanlineFrame = scanline.display.GetFramebuffer();
+  EXPECT_TRUE(std::equal(frame.begin(), frame.end(), scanlineFrame.begin()));
+  EXPECT_TRUE(dot.timeline == scanline.timeline);
+}
+}  // namespace
+
+TEST(PPU_WINDOW, SCANLINE_MATCHES_DOT_RENDERER)
+{
+  ExpectSameOutput(LCDC_WINDOW, 7, 0, 0, 1);
+  ExpectSameOutput(LCDC_WINDOW, 87, 40, 3, 2);
+  ExpectSameOutput(LCDC_WINDOW_LOW_MAP, 166, 143, 6, 3);
+  ExpectSameOutput(LCDC_WINDOW, 167, 0, 0, 4);
+}
+
+TEST(PPU_WINDOW, SCANLINE_MATCHES_DOT_RENDERER_LEFT_OF_SCREEN)
+{
+  ExpectSameOutput(LCDC_WINDOW, 0, 20, 0, 5);
+  ExpectSameOutput(LCDC_WINDOW, 3, 0, 7, 6);
+}
+
+TEST(PPU_WINDOW, SCANLINE_MATCHES_DOT_RENDERER_WITH_SPRITES)
+{
+  ExpectSameOutput(LCDC_WINDOW_SPRITES, 50, 30, 2, 7);
+  ExpectSameOutput(LCDC_WINDOW_SPRITES, 5, 0, 5, 8);
+}
+
+TEST(PPU_WINDOW, LINE_COUNTER_SKIPS_LINES_WITHOUT_WINDOW)
+{
+  for (auto renderMode : {Ppu::RenderMode::Dot, Ppu::RenderMode::Scanline})
+  {
+    PpuRun run{renderMode};
+    // tiles 1 - 3 are solid colors 1 - 3, background is tile 0 (color 0)
+    for (std::uint16_t tile{1}; tile < 4; ++tile)
+    {
+      for (std::uint16_t row{0}; row < 8; ++row)
+      {
+        auto addr =
+            static_cast<std::uint16_t>(0x8000 + (tile * 16) + (row * 2));
+        run.mmu.Write(addr, (tile & 0x1U) != 0 ? 0xFF : 0x00);
+        run.mmu.Write(static_cast<std::uint16_t>(addr + 1),
+            (tile & 0x2U) != 0 ? 0xFF : 0x00);
+      }
+    }
+    // row r of the window tile map shows color (r % 3) + 1
+    for (std::uint16_t entry{0}; entry < 0x400; ++entry)
+    {
+      run.mmu.Write(static_cast<std::uint16_t>(BG_WIN_TILEMAP_ADDRESS1 + entry),
+          static_cast<std::uint8_t>(((entry / 32) % 3) + 1));
+    }
+    run.mmu.Write(WX_REGISTER_ADDRESS, 7 + 40);
+    run.mmu.Write(WY_REGISTER_ADDRESS, 0);
+    // window is off for lines 8 - 23
+    run.Run([&run]() {
+      auto ly = run.mmu.Read(LY_REGISTER_ADDRESS);
+      run.mmu.Write(LCDC_REGISTER_ADDRESS,
+          ly >= 8 && ly < 24 ? LCDC_WINDOW_OFF : LCDC_WINDOW);
+    });
+
+    EXPECT_EQ(run.Pixel(39, 0), 0);
+    EXPECT_EQ(run.Pixel(40, 0), 1);
+    EXPECT_EQ(run.Pixel(40, 7), 1);
+    EXPECT_EQ(run.Pixel(40, 8), 0);
+    // line 24 draws window line 8
+    EXPECT_EQ(run.Pixel(40, 24), 2);
+    EXPECT_EQ(run.Pixel(159, 31), 2);
+    EXPECT_EQ(run.Pixel(40, 32), 3);
+  }
+}
@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+
+#include "common/cpurun.hpp"
+#include "interrupt.hpp"
+#include "mmu.hpp"
+#include "scheduler.hpp"
+#include "timer.hpp"
+
+namespace
+{
+constexpr std::uint16_t TIMA_ADDRESS{0xFF05};
+constexpr std::uint16_t TAC_ADDRESS{0xFF07};
+constexpr std::uint16_t IF_ADDRESS{0xFF0F};
+
+// TAC values, timer enabled with a period of 1024 and 16 cycles
+constexpr std::uint8_t TAC_1024{0x04};
+constexpr std::uint8_t TAC_16{0x05};
+}  // namespace
+
+TEST(TIMER_SCHEDULE, SHORTER_PERIOD_KEEPS_OVERFLOW_AHEAD)
+{
+  MemoryManagementUnit mmu;
+  Scheduler scheduler;
+  auto interrupt = std::make_shared<Interrupt>();
+  auto timer = std::make_shared<Timer>(mmu, scheduler);
+  mmu.AddMemoryRange(interrupt);
+  mmu.AddMemoryRange(timer);
+
+  mmu.Write(TAC_ADDRESS, TAC_1024);
+  mmu.Write(TIMA_ADDRESS, 0xFF);
+  scheduler.Advance(900);
+  mmu.Write(TAC_ADDRESS, TAC_16);
+
+  // the 900 cycles left over are 56 periods of 16 cycles, TIMA overflowed on
+  // the first one and counts on from TMA
+  EXPECT_NE(mmu.Read(IF_ADDRESS) & (1U << InterruptType::TIMER), 0U);
+  EXPECT_EQ(mmu.Read(TIMA_ADDRESS), 55);
+  EXPECT_EQ(scheduler.NextEventTime(), 900U + ((0x100U - 55U) * 16U) - 4U);
+}
+
+TEST(TIMER_SCHEDULE, READ_MODIFY_WRITE_ENABLES_TIMER)
+{
+  // LD HL,TAC; SET 2,(HL)
+  CpuRun run{0x21, 0x07, 0xFF, 0xCB, 0xD6};
+  run.mmu.AddMemoryRange(std::make_shared<Timer>(run.mmu, run.scheduler));
+
+  run.Step(1);
+  auto enabled = run.scheduler.Now();
+  run.Step(1);
+  EXPECT_EQ(run.mmu.Read(TAC_ADDRESS), TAC_1024);
+  EXPECT_EQ(run.scheduler.NextEventTime(), enabled + (0x100U * 1024U));
+}